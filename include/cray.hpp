@@ -1,8 +1,13 @@
 #pragma once
 
+#include "cray/diff.hpp"
+#include "cray/dump.hpp"
 #include "cray/load.hpp"
 #include "cray/node.hpp"
+#include "cray/path.hpp"
 #include "cray/props.hpp"
 #include "cray/report.hpp"
+#include "cray/schema.hpp"
 #include "cray/source.hpp"
 #include "cray/types.hpp"
+#include "cray/writer.hpp"
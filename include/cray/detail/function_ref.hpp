@@ -0,0 +1,47 @@
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace cray {
+namespace detail {
+
+template<typename Signature>
+class FunctionRef;
+
+/**
+ * @brief Non-owning reference to a callable.
+ *
+ * Unlike `std::function`, it never allocates and calls through a single function pointer. The
+ * referenced callable must outlive the FunctionRef, so it is meant for callback parameters only.
+ */
+template<typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+   public:
+	template<typename F>
+	    requires(!std::same_as<std::remove_cvref_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, Args...>)
+	FunctionRef(F&& f) noexcept
+	    : obj_(const_cast<void*>(static_cast<void const*>(std::addressof(f))))
+	    , call_([](void* obj, Args... args) -> R {
+		    auto& f = *static_cast<std::remove_reference_t<F>*>(obj);
+		    if constexpr(std::is_void_v<R>) {
+			    std::invoke(f, std::forward<Args>(args)...);
+		    } else {
+			    return std::invoke(f, std::forward<Args>(args)...);
+		    }
+	    }) { }
+
+	inline R operator()(Args... args) const {
+		return this->call_(this->obj_, std::forward<Args>(args)...);
+	}
+
+   private:
+	void* obj_;
+	R (*call_)(void*, Args...);
+};
+
+}  // namespace detail
+}  // namespace cray
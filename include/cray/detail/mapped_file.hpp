@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace cray {
+namespace detail {
+
+/**
+ * @brief Read-only contents of a whole file.
+ *
+ * A regular file is memory-mapped where the platform supports it; anything else, e.g. a pipe,
+ * is read into memory. Either way the bytes are aligned for any scalar type.
+ */
+class MappedFile {
+   public:
+	/**
+	 * @throw std::system_error If the file cannot be opened or read.
+	 */
+	static std::shared_ptr<MappedFile const> open(std::filesystem::path const& path);
+
+	MappedFile(MappedFile const&)            = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+
+	~MappedFile();
+
+	inline std::span<std::byte const> bytes() const {
+		return std::span<std::byte const>(this->data_, this->size_);
+	}
+
+	inline bool isMapped() const {
+		return this->is_mapped_;
+	}
+
+   private:
+	MappedFile() = default;
+
+	std::byte const* data_      = nullptr;
+	std::size_t      size_      = 0;
+	bool             is_mapped_ = false;
+
+	// Holds the contents if the file is not mapped.
+	std::vector<std::byte> buffer_;
+};
+
+}  // namespace detail
+}  // namespace cray
@@ -8,10 +8,14 @@
 #include <string>
 #include <utility>
 
+#include "cray/detail/function_ref.hpp"
 #include "cray/detail/interval.hpp"
 #include "cray/detail/ordered_set.hpp"
+#include "cray/dom.hpp"
 #include "cray/source.hpp"
+#include "cray/symbol.hpp"
 #include "cray/types.hpp"
+#include "cray/writer.hpp"
 
 namespace cray {
 
@@ -52,7 +56,17 @@ class Prop {
 		return "unknown";
 	}
 
-	virtual bool ok() const = 0;
+	/**
+	 * @brief Tests if the value at the current source satisfies this Prop.
+	 */
+	inline bool ok() const {
+		return this->okFrom(this->source ? Source::Cursor(*this->source) : Source::Cursor());
+	}
+
+	/**
+	 * @brief Tests if the value at \a src satisfies this Prop.
+	 */
+	virtual bool okFrom(Source::Cursor const& src) const = 0;
 
 	virtual bool hasDefault() const = 0;
 
@@ -110,7 +124,7 @@ class TransitiveProp: public virtual Prop {
 		throw InvalidAccessError();
 	}
 
-	bool ok() const {
+	bool okFrom(Source::Cursor const& src) const override {
 		throw InvalidAccessError();
 	}
 
@@ -146,7 +160,14 @@ class CodecProp: public virtual Prop {
 		this->encodeInto_(dst, value);
 	}
 
-	inline bool decodeFrom(Source const& src, StorageType& value) const {
+	/**
+	 * @brief Streams \a value to \a dst without building a Source.
+	 */
+	inline void encodeTo(Writer& dst, StorageType const& value) const {
+		this->encodeTo_(dst, value);
+	}
+
+	inline bool decodeFrom(Source::Cursor const& src, StorageType& value) const {
 		if(this->decodeFrom_(src, value)) {
 			return true;
 		}
@@ -170,7 +191,7 @@ class CodecProp: public virtual Prop {
 			return false;
 		}
 
-		return this->decodeFrom(*this->source, value);
+		return this->decodeFrom(Source::Cursor(*this->source), value);
 	}
 
 	std::optional<StorageType> opt() const {
@@ -192,7 +213,18 @@ class CodecProp: public virtual Prop {
    protected:
 	virtual void encodeInto_(Source& dst, StorageType const& value) const = 0;
 
-	virtual bool decodeFrom_(Source const& src, StorageType& value) const = 0;
+	/**
+	 * @brief Encodes into a temporary Source and writes it. Codecs override it to write \a value
+	 * directly.
+	 */
+	virtual void encodeTo_(Writer& dst, StorageType const& value) const {
+		auto const src = Source::fromDom(std::make_shared<Dom>());
+		this->encodeInto_(*src, value);
+
+		dst.write(Source::Cursor(*src));
+	}
+
+	virtual bool decodeFrom_(Source::Cursor const& src, StorageType& value) const = 0;
 };
 
 class RootProp: public Prop {
@@ -206,12 +238,12 @@ class RootProp: public Prop {
 		return "Root";
 	}
 
-	bool ok() const override {
+	bool okFrom(Source::Cursor const& src) const override {
 		if(this->next_prop == nullptr) [[unlikely]] {
 			return false;
 		}
 
-		return this->next_prop->ok();
+		return this->next_prop->okFrom(src);
 	}
 
 	bool hasDefault() const override {
@@ -261,30 +293,36 @@ class KeyedPropHolder: public PropHolder {
 	using PropHolder::PropHolder;
 
 	void markRequired(Reference const& ref) override {
-		this->required_keys.insert(ref.key());
+		this->required_keys.insert(ref.symbol());
 	};
 
 	bool needs(Reference const& ref) const override {
 		if(!ref.isKey()) {
 			return false;
 		}
-		return this->required_keys.contains(ref.key());
+		return this->required_keys.contains(ref.symbol());
 	}
 
-	virtual void forEachProps(Source const& source, std::function<void(std::string const&, std::shared_ptr<Prop> const&)> const& functor) const = 0;
+	virtual void forEachProps(Source const& source, FunctionRef<void(std::string const&, std::shared_ptr<Prop> const&)> functor) const = 0;
 
-	void forEachProps(std::function<void(std::string const&, std::shared_ptr<Prop> const&)> const& functor) const {
+	void forEachProps(FunctionRef<void(std::string const&, std::shared_ptr<Prop> const&)> functor) const {
 		this->forEachProps(*this->source, functor);
 	}
 
-	OrderedSet<std::string> required_keys;
+	/**
+	 * @brief Visits the Props of the keys declared by this holder, unlike `forEachProps` without
+	 * binding them to a Source. A holder of the same Prop for any key declares none.
+	 */
+	virtual void forEachDeclared(FunctionRef<void(Symbol const&, Prop const&)> functor) const { }
+
+	OrderedSet<Symbol> required_keys;
 };
 
 class IndexedPropHolder: public PropHolder {
    public:
 	using PropHolder::PropHolder;
 
-	virtual void forEachProps(Source const& source, std::function<void(std::size_t, std::shared_ptr<Prop> const&)> const& functor) const = 0;
+	virtual void forEachProps(Source const& source, FunctionRef<void(std::size_t, std::shared_ptr<Prop> const&)> functor) const = 0;
 };
 
 template<Type T>
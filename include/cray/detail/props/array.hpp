@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <utility>
 
+#include "cray/detail/function_ref.hpp"
 #include "cray/detail/prop.hpp"
 #include "cray/types.hpp"
 
@@ -76,20 +77,18 @@ class ArrayProp
 		return "List of " + this->next_prop->name();
 	}
 
-	bool ok() const override {
-		if(!this->source->is(Type::List)) {
+	bool okFrom(Source::Cursor const& src) const override {
+		if(!src.is(Type::List)) {
 			return !this->isNeeded() || this->hasDefault();
 		}
 
-		std::size_t const size = this->source->size();
+		std::size_t const size = src.size();
 		if(size != N) {
 			return false;
 		}
 
 		for(std::size_t i = 0; i < size; ++i) {
-			this->next_prop->source = this->source->next(i);
-
-			bool const ok = this->next_prop->ok();
+			bool const ok = this->next_prop->okFrom(src.next(i));
 			if(!ok) {
 				return false;
 			}
@@ -130,7 +129,7 @@ class ArrayProp
 		return Interval<std::size_t>::Singleton(N);
 	}
 
-	void forEachProps(Source const& source, std::function<void(std::size_t, std::shared_ptr<Prop> const&)> const& functor) const override {
+	void forEachProps(Source const& source, FunctionRef<void(std::size_t, std::shared_ptr<Prop> const&)> functor) const override {
 		for(std::size_t i = 0; i < N; ++i) {
 			this->next_prop->source = source.next(i);
 			this->next_prop->ref    = i;
@@ -149,7 +148,15 @@ class ArrayProp
 		}
 	}
 
-	bool decodeFrom_(Source const& src, StorageType& value) const {
+	void encodeTo_(Writer& dst, StorageType const& value) const {
+		dst.beginList();
+		for(auto const& next_value: value) {
+			this->next_prop->encodeTo(dst, next_value);
+		}
+		dst.endList();
+	}
+
+	bool decodeFrom_(Source::Cursor const& src, StorageType& value) const {
 		if(!src.is(Type::List)) {
 			return false;
 		}
@@ -159,8 +166,7 @@ class ArrayProp
 		}
 
 		for(std::size_t i = 0; i < N; ++i) {
-			auto const next_src = src.next(i);
-			auto const ok       = this->next_prop->decodeFrom(*next_src, value.at(i));
+			auto const ok = this->next_prop->decodeFrom(src.next(i), value.at(i));
 			if(!ok) {
 				return false;
 			}
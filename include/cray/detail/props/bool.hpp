@@ -48,9 +48,9 @@ class BoolProp: public ScalarProp<Type::Bool> {
 		return "Bool";
 	}
 
-	bool ok() const override {
+	bool okFrom(Source::Cursor const& src) const override {
 		StorageType value;
-		if(!this->source->get(value)) {
+		if(!src.get(value)) {
 			return !this->isNeeded() || this->default_value.has_value();
 		}
 
@@ -58,7 +58,7 @@ class BoolProp: public ScalarProp<Type::Bool> {
 	}
 
    protected:
-	bool decodeFrom_(Source const& src, StorageType& value) const override {
+	bool decodeFrom_(Source::Cursor const& src, StorageType& value) const override {
 		if(!src.get(value)) {
 			return false;
 		}
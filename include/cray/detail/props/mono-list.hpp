@@ -4,11 +4,14 @@
 #include <cstddef>
 #include <memory>
 #include <optional>
+#include <span>
 #include <type_traits>
 #include <vector>
 
+#include "cray/detail/function_ref.hpp"
 #include "cray/detail/interval.hpp"
 #include "cray/detail/prop.hpp"
+#include "cray/detail/props/numeric.hpp"
 #include "cray/types.hpp"
 
 namespace cray {
@@ -84,20 +87,18 @@ class MonoListProp
 		return "List of " + this->next_prop->name();
 	}
 
-	bool ok() const override {
-		if(!this->source->is(Type::List)) {
+	bool okFrom(Source::Cursor const& src) const override {
+		if(!src.is(Type::List)) {
 			return !this->isNeeded() || this->hasDefault();
 		}
 
-		std::size_t const size = this->source->size();
+		std::size_t const size = src.size();
 		if(!this->interval().contains(size)) {
 			return false;
 		}
 
 		for(std::size_t i = 0; i < size; ++i) {
-			this->next_prop->source = this->source->next(i);
-
-			bool const ok = this->next_prop->ok();
+			bool const ok = this->next_prop->okFrom(src.next(i));
 			if(!ok) {
 				return false;
 			}
@@ -134,7 +135,7 @@ class MonoListProp
 		return this->size;
 	}
 
-	void forEachProps(Source const& source, std::function<void(std::size_t, std::shared_ptr<Prop> const&)> const& functor) const override {
+	void forEachProps(Source const& source, FunctionRef<void(std::size_t, std::shared_ptr<Prop> const&)> functor) const override {
 		std::size_t const size = source.size();
 		for(std::size_t i = 0; i < size; ++i) {
 			this->next_prop->source = source.next(i);
@@ -156,7 +157,15 @@ class MonoListProp
 		}
 	}
 
-	bool decodeFrom_(Source const& src, StorageType& value) const {
+	void encodeTo_(Writer& dst, StorageType const& value) const {
+		dst.beginList();
+		for(auto const& next_value: value) {
+			this->next_prop->encodeTo(dst, next_value);
+		}
+		dst.endList();
+	}
+
+	bool decodeFrom_(Source::Cursor const& src, StorageType& value) const {
 		if(!src.is(Type::List)) {
 			return false;
 		}
@@ -166,10 +175,15 @@ class MonoListProp
 			return false;
 		}
 
+		if constexpr(std::is_arithmetic_v<V> && !std::is_same_v<V, bool>) {
+			if(this->decodeNumbers_(src, value)) {
+				return true;
+			}
+		}
+
 		value.resize(size);
 		for(std::size_t index = 0; index < size; ++index) {
-			auto const next = src.next(index);
-			auto const ok   = this->next_prop->decodeFrom(*next, value.at(index));
+			auto const ok = this->next_prop->decodeFrom(src.next(index), value.at(index));
 			if(!ok) {
 				return false;
 			}
@@ -177,6 +191,51 @@ class MonoListProp
 
 		return true;
 	}
+
+	/**
+	 * @brief Reads a list of numbers at once and validates them afterwards.
+	 *
+	 * @return `false` if any element has to be decoded one by one, e.g. it is of another type or
+	 * is replaced by the default value.
+	 */
+	bool decodeNumbers_(Source::Cursor const& src, StorageType& value) const {
+		using Storage = StorageOf<TypeFor<V>>;
+
+		auto const* const prop = dynamic_cast<NumericProp<TypeFor<V>> const*>(this->next_prop.get());
+		if(prop == nullptr) {
+			return false;
+		}
+
+		auto const size = src.size();
+		if constexpr(std::is_same_v<V, Storage>) {
+			value.resize(size);
+			if(!src.get(std::span<Storage>(value))) {
+				return false;
+			}
+
+			for(auto& v: value) {
+				if(!prop->constrain(v)) {
+					return false;
+				}
+			}
+		} else {
+			std::vector<Storage> buffer(size);
+			if(!src.get(std::span<Storage>(buffer))) {
+				return false;
+			}
+
+			value.resize(size);
+			for(std::size_t i = 0; i < size; ++i) {
+				if(!prop->constrain(buffer[i])) {
+					return false;
+				}
+
+				value[i] = static_cast<V>(buffer[i]);
+			}
+		}
+
+		return true;
+	}
 };
 
 template<std::derived_from<Prop> P>
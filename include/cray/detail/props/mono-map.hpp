@@ -8,8 +8,10 @@
 #include <unordered_map>
 #include <utility>
 
+#include "cray/detail/function_ref.hpp"
 #include "cray/detail/ordered_set.hpp"
 #include "cray/detail/prop.hpp"
+#include "cray/symbol.hpp"
 #include "cray/types.hpp"
 
 namespace cray {
@@ -65,7 +67,7 @@ class MonoMapProp
 			}
 		}
 
-		inline Describer const& containing(OrderedSet<std::string> keys) const {
+		inline Describer const& containing(OrderedSet<Symbol> keys) const {
 			this->prop_->required_keys = std::move(keys);
 			return *this;
 		}
@@ -85,12 +87,12 @@ class MonoMapProp
 		return "Map of " + this->next_prop->name();
 	}
 
-	bool ok() const override {
-		if(!this->source->is(Type::Map)) {
+	bool okFrom(Source::Cursor const& src) const override {
+		if(!src.is(Type::Map)) {
 			return !this->isNeeded() || this->hasDefault();
 		}
 
-		if(!std::ranges::all_of(this->required_keys, HeldBy(*this->source))) {
+		if(!std::ranges::all_of(this->required_keys, HeldBy(src))) {
 			return false;
 		}
 
@@ -118,9 +120,9 @@ class MonoMapProp
 		return Interval<std::size_t>::All();
 	}
 
-	void forEachProps(Source const& source, std::function<void(std::string const&, std::shared_ptr<Prop> const&)> const& functor) const override {
-		this->source->keys([&](std::string const& key) {
-			this->next_prop->source = source.next(key);
+	void forEachProps(Source const& source, FunctionRef<void(std::string const&, std::shared_ptr<Prop> const&)> functor) const override {
+		source.entries([&](std::string const& key, std::shared_ptr<Source> const& next) {
+			this->next_prop->source = next;
 			this->next_prop->ref    = key;
 
 			functor(key, this->next_prop);
@@ -138,7 +140,16 @@ class MonoMapProp
 		}
 	}
 
-	bool decodeFrom_(Source const& src, StorageType& value) const {
+	void encodeTo_(Writer& dst, StorageType const& value) const {
+		dst.beginMap();
+		for(auto const& [key, next_value]: value) {
+			dst.key(key);
+			this->next_prop->encodeTo(dst, next_value);
+		}
+		dst.endMap();
+	}
+
+	bool decodeFrom_(Source::Cursor const& src, StorageType& value) const {
 		if(!src.is(Type::Map)) {
 			return false;
 		}
@@ -147,9 +158,8 @@ class MonoMapProp
 			return false;
 		}
 
-		src.keys([&](std::string const& key) {
-			auto next = src.next(key);
-			return this->next_prop->decodeFrom(*next, value[key]);
+		src.entries([&](std::string const& key, Source::Cursor const& next) {
+			return this->next_prop->decodeFrom(next, value[key]);
 		});
 
 		return true;
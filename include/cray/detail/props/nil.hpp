@@ -49,9 +49,9 @@ class NilProp: public ScalarProp<Type::Nil> {
 		return "Nil";
 	}
 
-	bool ok() const override {
+	bool okFrom(Source::Cursor const& src) const override {
 		StorageType value;
-		if(!this->source->get(value)) {
+		if(!src.get(value)) {
 			return !this->isNeeded() || this->default_value.has_value();
 		}
 
@@ -59,7 +59,7 @@ class NilProp: public ScalarProp<Type::Nil> {
 	}
 
    protected:
-	bool decodeFrom_(Source const& src, StorageType& value) const override {
+	bool decodeFrom_(Source::Cursor const& src, StorageType& value) const override {
 		if(!src.get(value)) {
 			return false;
 		}
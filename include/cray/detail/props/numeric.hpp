@@ -9,6 +9,7 @@
 
 #include "cray/detail/interval.hpp"
 #include "cray/detail/prop.hpp"
+#include "cray/detail/props/scalar.hpp"
 #include "cray/source.hpp"
 #include "cray/types.hpp"
 
@@ -88,9 +89,9 @@ class NumericProp: public ScalarProp<T> {
 
 	using ScalarProp<T>::ScalarProp;
 
-	bool ok() const override {
+	bool okFrom(Source::Cursor const& src) const override {
 		StorageType value;
-		if(!this->source->get(value)) {
+		if(!NumericProp::read_(src, value)) {
 			return !this->isNeeded() || this->default_value.has_value();
 		}
 
@@ -109,16 +110,11 @@ class NumericProp: public ScalarProp<T> {
 		this->encodeInto(dst, this->default_value.value());
 	}
 
-	DivisibilityTest<StorageType> multiple_of;
-	Interval<StorageType>         interval;
-	bool                          with_clamp = false;
-
-   protected:
-	bool decodeFrom_(Source const& src, StorageType& value) const override {
-		if(!src.get(value)) {
-			return false;
-		}
-
+	/**
+	 * @brief Tests \a value against the constraints, clamping it into the interval if
+	 * `with_clamp` is set.
+	 */
+	bool constrain(StorageType& value) const {
 		if(!this->multiple_of(value)) {
 			return false;
 		}
@@ -133,6 +129,39 @@ class NumericProp: public ScalarProp<T> {
 
 		return true;
 	}
+
+	DivisibilityTest<StorageType> multiple_of;
+	Interval<StorageType>         interval;
+	bool                          with_clamp = false;
+
+   protected:
+	/**
+	 * @brief Reads the value at \a src. An integer, e.g. `1` in JSON, is read as a floating point
+	 * number too, although the Source does not report it as `Type::Num`.
+	 */
+	static bool read_(Source::Cursor const& src, StorageType& value) {
+		if(src.get(value)) {
+			return true;
+		}
+
+		if constexpr(T == Type::Num) {
+			StorageOf<Type::Int> integer;
+			if(src.get(integer)) {
+				value = static_cast<StorageType>(integer);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool decodeFrom_(Source::Cursor const& src, StorageType& value) const override {
+		if(!NumericProp::read_(src, value)) {
+			return false;
+		}
+
+		return this->constrain(value);
+	}
 };
 
 template<typename V>
@@ -164,7 +193,13 @@ class BasicNumericProp
 		dst.set(v);
 	}
 
-	bool decodeFrom_(Source const& src, V& value) const override {
+	void encodeTo_(Writer& dst, V const& value) const override {
+		auto const v = static_cast<StorageOf<TypeFor<V>>>(value);
+
+		dst.value(v);
+	}
+
+	bool decodeFrom_(Source::Cursor const& src, V& value) const override {
 		StorageOf<TypeFor<V>> v;
 
 		bool const ok = NumericProp<TypeFor<V>>::decodeFrom_(src, v);
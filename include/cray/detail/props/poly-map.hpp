@@ -4,9 +4,11 @@
 #include <memory>
 #include <string>
 
+#include "cray/detail/function_ref.hpp"
 #include "cray/detail/ordered_map.hpp"
 #include "cray/detail/ordered_set.hpp"
 #include "cray/detail/prop.hpp"
+#include "cray/symbol.hpp"
 #include "cray/types.hpp"
 
 namespace cray {
@@ -25,14 +27,13 @@ class BasicPolyMapProp
 		return Type::Map;
 	}
 
-	bool ok() const override {
-		if(!this->source->is(Type::Map)) {
+	bool okFrom(Source::Cursor const& src) const override {
+		if(!src.is(Type::Map)) {
 			return !this->isNeeded() || this->hasDefault();
 		}
 
 		for(auto const& [key, next_prop]: this->next_props) {
-			next_prop->source = this->source->next(key);
-			if(next_prop->ok()) {
+			if(next_prop->okFrom(src.next(key))) {
 				continue;
 			}
 
@@ -53,7 +54,7 @@ class BasicPolyMapProp
 			}
 		}
 
-		auto const& key = ref.key();
+		auto const key = ref.symbol();
 
 		if(this->source) {
 			// `this` does not have source if it is created by
@@ -65,7 +66,7 @@ class BasicPolyMapProp
 	}
 
 	std::shared_ptr<Prop> at(Reference const& ref) const override {
-		auto const it = this->next_props.find(ref.key());
+		auto const it = this->next_props.find(ref.symbol());
 		if(it == this->next_props.cend()) {
 			return nullptr;
 		} else {
@@ -81,16 +82,22 @@ class BasicPolyMapProp
 		return Interval<std::size_t>::All();
 	}
 
-	void forEachProps(Source const& source, std::function<void(std::string const&, std::shared_ptr<Prop> const&)> const& functor) const override {
+	void forEachProps(Source const& source, FunctionRef<void(std::string const&, std::shared_ptr<Prop> const&)> functor) const override {
 		for(auto const& [key, next_prop]: this->next_props) {
 			next_prop->source = source.next(key);
 			next_prop->ref    = key;
 
-			functor(key, next_prop);
+			functor(key.str(), next_prop);
+		}
+	}
+
+	void forEachDeclared(FunctionRef<void(Symbol const&, Prop const&)> functor) const override {
+		for(auto const& [key, next_prop]: this->next_props) {
+			functor(key, *next_prop);
 		}
 	}
 
-	OrderedMap<std::string, std::shared_ptr<NextPropType>> next_props;
+	OrderedMap<Symbol, std::shared_ptr<NextPropType>> next_props;
 };
 
 class PolyMpaProp: public BasicPolyMapProp<Prop> {
@@ -109,7 +116,7 @@ class PolyMpaProp: public BasicPolyMapProp<Prop> {
 	}
 
 	void markRequired(Reference const& ref) override {
-		required_keys.insert(ref.key());
+		required_keys.insert(ref.symbol());
 	}
 };
 
@@ -5,6 +5,7 @@
 #include "cray/detail/prop.hpp"
 #include "cray/source.hpp"
 #include "cray/types.hpp"
+#include "cray/writer.hpp"
 
 namespace cray {
 namespace detail {
@@ -24,6 +25,10 @@ class ScalarProp: public CodecProp<StorageOf<T>> {
 	void encodeInto_(Source& dst, StorageType const& value) const override {
 		dst.set(value);
 	}
+
+	void encodeTo_(Writer& dst, StorageType const& value) const override {
+		dst.value(value);
+	}
 };
 
 }  // namespace detail
@@ -60,9 +60,9 @@ class StrProp: public ScalarProp<Type::Str> {
 		return "String";
 	}
 
-	bool ok() const override {
+	bool okFrom(Source::Cursor const& src) const override {
 		StorageType value;
-		if(!this->source->get(value)) {
+		if(!src.get(value)) {
 			return !this->isNeeded() || this->default_value.has_value();
 		}
 
@@ -81,7 +81,7 @@ class StrProp: public ScalarProp<Type::Str> {
 	Interval<std::size_t>   length;
 
    protected:
-	bool decodeFrom_(Source const& src, StorageType& value) const override {
+	bool decodeFrom_(Source::Cursor const& src, StorageType& value) const override {
 		if(!src.get(value)) {
 			return false;
 		}
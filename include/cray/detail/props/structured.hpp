@@ -74,22 +74,36 @@ class FieldProp
 		CodecProp<BaseStorageType>::encodeInto(*next, v);
 	}
 
-	bool decodeFrom_(Source const& src, MappedType& value) const override {
+	void encodeTo_(Writer& dst, MappedType const& value) const override {
+		if constexpr(IsOptional<V>) {
+			if(!(value.*this->member)) {
+				return;
+			}
+
+			dst.key(this->ref.key());
+			CodecProp<BaseStorageType>::encodeTo(dst, *(value.*this->member));
+		} else {
+			dst.key(this->ref.key());
+			CodecProp<BaseStorageType>::encodeTo(dst, value.*this->member);
+		}
+	}
+
+	bool decodeFrom_(Source::Cursor const& src, MappedType& value) const override {
 		auto const next = src.next(this->ref);
-		if(next == nullptr) {
+		if(!next) {
 			return false;
 		}
 
 		if constexpr(IsOptional<V>) {
 			BaseStorageType v;
-			if(CodecProp<BaseStorageType>::decodeFrom(*next, v)) {
+			if(CodecProp<BaseStorageType>::decodeFrom(next, v)) {
 				value.*this->member = v;
 				return true;
 			} else {
 				return false;
 			}
 		} else {
-			return CodecProp<BaseStorageType>::decodeFrom(*next, value.*this->member);
+			return CodecProp<BaseStorageType>::decodeFrom(next, value.*this->member);
 		}
 	}
 };
@@ -181,7 +195,16 @@ class StructuredProp
 		}
 	}
 
-	bool decodeFrom_(Source const& src, StorageType& value) const override {
+	void encodeTo_(Writer& dst, StorageType const& value) const override {
+		// Each field writes its own key.
+		dst.beginMap();
+		for(auto const& [key, next_prop]: this->next_props) {
+			next_prop->encodeTo(dst, value);
+		}
+		dst.endMap();
+	}
+
+	bool decodeFrom_(Source::Cursor const& src, StorageType& value) const override {
 		for(auto const& [key, next_prop]: this->next_props) {
 			// No need to src.next(key) since codec knows their ref and
 			// will navigate the Source with that ref.
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "cray/detail/function_ref.hpp"
+#include "cray/path.hpp"
+#include "cray/source.hpp"
+
+namespace cray {
+
+enum class Change {
+	Added,
+	Removed,
+	Modified,
+};
+
+struct Difference {
+	Change change;
+	Path   path;
+
+	bool operator==(Difference const& other) const = default;
+};
+
+/**
+ * @brief Reports every path whose node differs between \a from and \a to.
+ *
+ * A node whose type changed is reported as `Change::Modified` without descending into it.
+ * Subtrees that share storage, e.g. between snapshots of a persistent Source, are skipped without
+ * being visited. Map children are looked up with the position of the previous key as a hint, so
+ * comparing documents whose keys are in the same order is linear.
+ */
+void diff(Source::Cursor const& from, Source::Cursor const& to, detail::FunctionRef<void(Change change, Path const& path)> functor);
+
+std::vector<Difference> diff(Source::Cursor const& from, Source::Cursor const& to);
+
+}  // namespace cray
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cray/symbol.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+/**
+ * @brief Arena-owned document tree.
+ *
+ * Nodes, child tables, and string bytes live in three contiguous buffers and refer to each other
+ * by index; map keys are interned Symbols, so building a document costs a handful of amortized allocations and dropping it
+ * frees everything at once. Nodes are never moved or released individually; a node replaced by
+ * a write leaves its old storage behind until the whole Dom is cleared.
+ *
+ * A node of type `Type::Unspecified` is a hole, e.g. a list element that was skipped over; it
+ * is neither a scalar nor a container.
+ *
+ * Keys of a map are searched in order until it grows wide; from then on they are also kept in a
+ * hash index of that map, so looking up or adding a key takes constant time at any width.
+ */
+class Dom {
+   public:
+	using Index = std::uint32_t;
+
+	static constexpr Index npos = std::numeric_limits<Index>::max();
+
+	struct Node {
+		Type type = Type::Unspecified;
+
+		// Whether a string is plain text whose type is left to the reader; see `setPlain`.
+		bool is_plain = false;
+
+		// Whether a map has a key index.
+		bool is_indexed = false;
+
+		// Whether a string refers to bytes outside the Dom; see `setView`.
+		bool is_external = false;
+
+		// Number of children of a container or length of a string.
+		std::uint32_t size = 0;
+
+		// Number of child slots reserved for a container.
+		std::uint32_t capacity = 0;
+
+		union {
+			bool          boolean;
+			std::intmax_t integer;
+			double        number;
+
+			// Offset into the string bytes or into the child slots.
+			std::size_t offset = 0;
+
+			// First byte of an external string.
+			char const* data;
+		} value;
+	};
+
+	struct Slot {
+		Index node = npos;
+
+		// Key of a map child; unused for a list.
+		Symbol key;
+	};
+
+	Dom();
+
+	/**
+	 * @brief Drops every node but the root, which becomes `nil`. Buffers keep their capacity.
+	 */
+	void clear();
+
+	void reserve(std::size_t nodes, std::size_t bytes);
+
+	inline Index root() const {
+		return 0;
+	}
+
+	inline Node const& node(Index index) const {
+		return this->nodes_[index];
+	}
+
+	inline Type type(Index index) const {
+		return this->nodes_[index].type;
+	}
+
+	inline bool is(Index index, Type type) const {
+		auto const& node = this->nodes_[index];
+		return node.type == type || (node.is_plain && this->isPlainAs_(index, type));
+	}
+
+	/**
+	 * @brief Number of children of a container, or 0 for anything else.
+	 */
+	std::size_t size(Index index) const;
+
+	// clang-format off
+	bool get(Index index, StorageOf<Type::Nil>   value) const;
+	bool get(Index index, StorageOf<Type::Bool>& value) const;
+	bool get(Index index, StorageOf<Type::Int>&  value) const;
+	bool get(Index index, StorageOf<Type::Num>&  value) const;
+	bool get(Index index, StorageOf<Type::Str>&  value) const;
+	// clang-format on
+
+	/**
+	 * @brief Reads every element of a list into \a values in one pass.
+	 *
+	 * @return `false` if the node is not a list of `values.size()` elements of the type. \a values
+	 * may be partially written in that case.
+	 */
+	bool get(Index index, std::span<StorageOf<Type::Int>> values) const;
+	bool get(Index index, std::span<StorageOf<Type::Num>> values) const;
+
+	/**
+	 * @brief String held by a node. Empty if the node is not a string.
+	 *
+	 * The view is invalidated by any write to the Dom.
+	 */
+	std::string_view str(Index index) const;
+
+	/**
+	 * @brief \a n th child of a container in insertion order.
+	 *
+	 * @return Index of the child or `npos` if there is no such child.
+	 */
+	Index at(Index index, std::size_t n) const;
+
+	/**
+	 * @brief Key of the \a n th child of a map. Empty if the node is not a map.
+	 */
+	std::string_view keyAt(Index index, std::size_t n) const;
+
+	/**
+	 * @brief Key of the \a n th child of a map. The Symbol of the empty string if the node is not
+	 * a map.
+	 */
+	Symbol symbolAt(Index index, std::size_t n) const;
+
+	/**
+	 * @brief Child of a map with given \a key.
+	 *
+	 * @return Index of the child or `npos` if the node is not a map or has no such key.
+	 */
+	Index find(Index index, Symbol key) const;
+
+	/**
+	 * @brief Same as `find(index, key)` but tests the \a hint th child first. \a hint is set to the
+	 * position of the child if found.
+	 */
+	Index find(Index index, Symbol key, std::size_t& hint) const;
+
+	/**
+	 * @brief Same as `find(index, Symbol(key))` but does not intern \a key.
+	 */
+	Index find(Index index, std::string_view key) const;
+
+	inline Index find(Index index, char const* key) const {
+		return this->find(index, std::string_view(key));
+	}
+
+	// clang-format off
+	void set(Index index, StorageOf<Type::Nil>  value);
+	void set(Index index, StorageOf<Type::Bool> value);
+	void set(Index index, StorageOf<Type::Int>  value);
+	void set(Index index, StorageOf<Type::Num>  value);
+	void set(Index index, std::string_view      value);
+	// clang-format on
+
+	inline void set(Index index, char const* value) {
+		this->set(index, std::string_view(value));
+	}
+
+	/**
+	 * @brief Sets a string that also reads as a Bool, an Int, or a Num if its text spells one, the
+	 * way yaml-cpp reads plain scalars, e.g. `yes`, `0x1F`, or `.inf`. `type()` of the node is
+	 * `Type::Str`.
+	 */
+	void setPlain(Index index, std::string_view value);
+
+	/**
+	 * @brief Sets a string that refers to \a value instead of copying it into the Dom. The caller
+	 * keeps the bytes alive for as long as the Dom; `graft` copies them.
+	 */
+	void setView(Index index, std::string_view value);
+
+	/**
+	 * @brief Turns a node into an empty node of given \a type.
+	 */
+	void reset(Index index, Type type);
+
+	/**
+	 * @brief Reserves child slots of a container so that \a n children can be added without
+	 * relocating its child table.
+	 */
+	void reserve(Index index, std::size_t n);
+
+	/**
+	 * @brief Appends a hole to a list.
+	 *
+	 * @return Index of the new child.
+	 */
+	Index append(Index index);
+
+	/**
+	 * @brief Child of a list at position \a n, growing the list with holes if needed.
+	 */
+	Index child(Index index, std::size_t n);
+
+	/**
+	 * @brief Child of a map with given \a key, appending a hole if there is no such key.
+	 */
+	Index child(Index index, Symbol key);
+
+	/**
+	 * @brief Replaces a node with a copy of the subtree of \a src rooted at \a node.
+	 *
+	 * \a src can be this Dom as long as \a index is not in the subtree being copied.
+	 */
+	void graft(Index index, Dom const& src, Index node);
+
+   private:
+	// Number of keys from which a map is indexed. Below it, a linear scan over the keys is
+	// about as fast as hashing one.
+	static constexpr std::size_t IndexThreshold = 16;
+
+	// Position of each key in the child table of a map.
+	using KeyIndex = std::unordered_map<Symbol, std::uint32_t>;
+
+	bool isPlainAs_(Index index, Type type) const;
+
+	/**
+	 * @return Position of \a key in the child table of the map \a index, or `npos`.
+	 */
+	std::size_t position_(Index index, Symbol key) const;
+
+	Index make_();
+
+	template<Type T>
+	bool getAll_(Index index, std::span<StorageOf<T>> values) const;
+
+	std::size_t store_(std::string_view value);
+
+	Slot& push_(Index index);
+
+	std::vector<Node> nodes_;
+	std::vector<Slot> slots_;
+	std::vector<char> bytes_;
+
+	// Key indices of wide maps by their node.
+	std::unordered_map<Index, KeyIndex> indices_;
+};
+
+}  // namespace cray
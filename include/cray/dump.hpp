@@ -0,0 +1,46 @@
+#pragma once
+
+#include <concepts>
+#include <iosfwd>
+
+#include "cray/detail/prop.hpp"
+#include "cray/source.hpp"
+#include "cray/writer.hpp"
+
+namespace cray {
+namespace dump {
+
+inline void asYaml(std::ostream& dst, Source::Cursor const& src) {
+	YamlWriter writer(dst);
+	writer.write(src);
+}
+
+inline void asJson(std::ostream& dst, Source::Cursor const& src) {
+	JsonWriter writer(dst);
+	writer.write(src);
+}
+
+/**
+ * @brief Writes \a src in the binary snapshot format read by `Source::fromBinary` and
+ * `load::fromBinary`.
+ */
+void asBinary(std::ostream& dst, Source::Cursor const& src);
+
+/**
+ * @brief Writes \a value as described by \a describer in a single pass, without building a
+ * Source.
+ */
+template<std::derived_from<detail::Prop> P>
+void asYaml(std::ostream& dst, detail::Describer<P> const& describer, typename P::StorageType const& value) {
+	YamlWriter writer(dst);
+	detail::getProp(describer)->encodeTo(writer, value);
+}
+
+template<std::derived_from<detail::Prop> P>
+void asJson(std::ostream& dst, detail::Describer<P> const& describer, typename P::StorageType const& value) {
+	JsonWriter writer(dst);
+	detail::getProp(describer)->encodeTo(writer, value);
+}
+
+}  // namespace dump
+}  // namespace cray
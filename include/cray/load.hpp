@@ -1,18 +1,159 @@
 #pragma once
 
+#include <concepts>
+#include <cstddef>
 #include <filesystem>
+#include <functional>
 #include <iosfwd>
+#include <iterator>
 #include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "cray/detail/function_ref.hpp"
+#include "cray/detail/prop.hpp"
 #include "cray/source.hpp"
 
 namespace cray {
 
+class Writer;
+
+/**
+ * @brief Documents of a stream that holds many of them, e.g. YAML documents separated by `---`.
+ * Only the document being parsed is held in memory.
+ */
+class DocumentReader {
+   public:
+	virtual ~DocumentReader() { }
+
+	/**
+	 * @return The next document, or nullptr after the last one.
+	 */
+	virtual std::shared_ptr<Source> next() = 0;
+};
+
+/**
+ * @brief Lazy single-pass range over the documents of a DocumentReader.
+ */
+class Documents {
+   public:
+	class Iterator {
+	   public:
+		using value_type      = std::shared_ptr<Source>;
+		using difference_type = std::ptrdiff_t;
+
+		Iterator() = default;
+
+		Iterator(DocumentReader& reader)
+		    : reader_(&reader)
+		    , curr_(reader.next()) { }
+
+		inline value_type const& operator*() const {
+			return this->curr_;
+		}
+
+		inline Iterator& operator++() {
+			this->curr_ = this->reader_->next();
+			return *this;
+		}
+
+		inline void operator++(int) {
+			++*this;
+		}
+
+		inline bool operator==(std::default_sentinel_t) const {
+			return this->curr_ == nullptr;
+		}
+
+	   private:
+		DocumentReader* reader_ = nullptr;
+		value_type      curr_;
+	};
+
+	Documents() = default;
+
+	Documents(std::unique_ptr<DocumentReader> reader)
+	    : reader_(std::move(reader)) { }
+
+	/**
+	 * @return `false` if there is no reader, e.g. no loader of the requested name.
+	 */
+	explicit operator bool() const {
+		return this->reader_ != nullptr;
+	}
+
+	/**
+	 * @brief Reads the first document that is not read yet.
+	 */
+	inline Iterator begin() {
+		if(this->reader_ == nullptr) {
+			return Iterator();
+		}
+
+		return Iterator(*this->reader_);
+	}
+
+	inline std::default_sentinel_t end() const {
+		return std::default_sentinel;
+	}
+
+   private:
+	std::unique_ptr<DocumentReader> reader_;
+};
+
+/**
+ * @brief Parser of a format. An instance may be reused for many loads, one at a time, and may keep
+ * scratch buffers between them.
+ */
 class Loader {
    public:
+	virtual ~Loader() { }
+
 	virtual std::shared_ptr<Source> load(std::istream& in) = 0;
+
+	/**
+	 * @brief Parses \a data held in memory. Loaders that can parse a buffer directly override it;
+	 * the default reads \a data through a stream that refers to it without copying.
+	 *
+	 * A returned Source may refer to \a data, which then must outlive it, only if the loader
+	 * documents so.
+	 */
+	virtual std::shared_ptr<Source> load(std::string_view data);
+
+	inline std::shared_ptr<Source> load(std::span<std::byte const> data) {
+		return this->load(std::string_view(reinterpret_cast<char const*>(data.data()), data.size()));
+	}
+
+	/**
+	 * @brief Reads the documents of \a in one at a time. \a in must outlive the returned reader,
+	 * which must not refer to this loader. The default loads the whole stream as a single
+	 * document.
+	 */
+	virtual std::unique_ptr<DocumentReader> documents(std::istream& in);
+
+	/**
+	 * @brief Parses \a in into events of \a dst as they are read, without building a document.
+	 * Scalars that can be read as several types are passed to `Writer::scalar`, and map entries
+	 * that \a dst does not want may be skipped without being parsed. An exception thrown by \a dst
+	 * stops the parse. The default loads a Source and writes it.
+	 */
+	virtual void emit(std::istream& in, Writer& dst);
+
+	/**
+	 * @brief Reads the elements of the list at the top of \a in one at a time until \a functor
+	 * returns `false`. An element is dropped before the next one is read, so memory is bounded by
+	 * the largest element rather than by the list; \a functor must not keep the cursor. An empty
+	 * or `nil` document has no elements. The default builds each element from `emit`.
+	 *
+	 * @throws std::invalid_argument if the document is neither a list nor `nil`.
+	 */
+	virtual void elements(std::istream& in, detail::FunctionRef<bool(Source::Cursor const& element)> functor);
 };
 
 class LoaderFactory {
@@ -22,6 +163,9 @@ class LoaderFactory {
 	virtual std::shared_ptr<Loader> make() const = 0;
 };
 
+/**
+ * @brief Factories of loaders by name. Safe to use from many threads at once.
+ */
 class LoaderRegistry {
    public:
 	bool has(std::string const& name) const;
@@ -32,7 +176,19 @@ class LoaderRegistry {
 
 	std::shared_ptr<LoaderFactory> get(std::string const& name) const;
 
+	/**
+	 * @brief Loader made by the factory of \a name, taken from a pool of the calling thread.
+	 *
+	 * The loader goes back to the pool when the returned pointer is released on the same thread,
+	 * so later loads reuse it and its buffers. Released on another thread, it is destroyed.
+	 *
+	 * @return nullptr if there is no such factory.
+	 */
+	std::shared_ptr<Loader> acquire(std::string const& name) const;
+
    private:
+	mutable std::shared_mutex mutex_;
+
 	std::unordered_map<std::string, std::shared_ptr<LoaderFactory>> factories_;
 };
 
@@ -46,8 +202,15 @@ void add(std::string name, std::shared_ptr<LoaderFactory> factory);
 
 std::shared_ptr<LoaderFactory> get(std::string const& name);
 
+std::shared_ptr<Loader> acquire(std::string const& name);
+
 }  // namespace loader_registry
 
+/**
+ * @brief Runs \a task, possibly on another thread and after it returns.
+ */
+using Executor = std::function<void(std::function<void()> task)>;
+
 namespace load {
 
 inline std::shared_ptr<Source> fromJson(std::istream& in) {
@@ -58,6 +221,31 @@ inline std::shared_ptr<Source> fromJson(std::filesystem::path const& path) {
 	return Source::load("json", path);
 }
 
+inline std::shared_ptr<Source> parseJson(std::string_view data) {
+	return Source::parse("json", data);
+}
+
+/**
+ * @brief Reads the JSON document \a data as it is accessed instead of parsing it up front, so
+ * a large document of which only a part is read loads in about constant time.
+ *
+ * Each value is parsed the first time it is read, except that a large map or list is first
+ * scanned for where its children are. The returned Source is read-only and safe to read from
+ * many threads at once.
+ *
+ * @param owner Kept alive by the returned Source; \a data must outlive the Source otherwise.
+ * @throws std::invalid_argument when a malformed part of the document is read, rather than on
+ * this call.
+ */
+std::shared_ptr<Source> parseJsonLazily(std::string_view data, std::shared_ptr<void const> owner = nullptr);
+
+/**
+ * @brief Maps the file at \a path into memory and reads it as `parseJsonLazily` does.
+ *
+ * @throws std::system_error if the file cannot be read.
+ */
+std::shared_ptr<Source> fromJsonLazily(std::filesystem::path const& path);
+
 inline std::shared_ptr<Source> fromYaml(std::istream& in) {
 	return Source::load("yaml", in);
 }
@@ -66,6 +254,149 @@ inline std::shared_ptr<Source> fromYaml(std::filesystem::path const& path) {
 	return Source::load("yaml", path);
 }
 
+inline std::shared_ptr<Source> parseYaml(std::string_view data) {
+	return Source::parse("yaml", data);
+}
+
+/**
+ * @brief Documents of \a in read one at a time by the loader registered as \a name. \a in must
+ * outlive the returned range.
+ */
+Documents documents(std::string const& name, std::istream& in);
+
+inline Documents documentsFromYaml(std::istream& in) {
+	return documents("yaml", in);
+}
+
+/**
+ * @brief Elements of the list at the top of \a in read one at a time by the loader registered as
+ * \a name, as `Loader::elements` does.
+ *
+ * @throws std::invalid_argument if there is no such loader.
+ */
+void elements(std::string const& name, std::istream& in, detail::FunctionRef<bool(Source::Cursor const& element)> functor);
+
+/**
+ * @brief Checks and decodes each element of the list at the top of \a in with the Prop of
+ * \a item, e.g. the one given to a `MonoListProp`, and passes the values to \a functor until it
+ * returns `false`. Only one element is held in memory at a time.
+ *
+ * @return Index of the first element that is rejected, at which reading stops, or `std::nullopt`
+ * if there is none.
+ * @throws std::invalid_argument if there is no such loader or the document is not a list.
+ */
+template<std::derived_from<detail::Prop> P, typename F>
+    requires(std::derived_from<P, detail::CodecProp<typename P::StorageType>>)
+std::optional<std::size_t> decodeElements(std::string const& name, std::istream& in, detail::Describer<P> const& item, F&& functor) {
+	auto const prop = detail::getProp(item);
+
+	std::size_t                index = 0;
+	std::optional<std::size_t> rejected;
+	elements(name, in, [&](Source::Cursor const& element) {
+		typename P::StorageType value;
+		if(!prop->okFrom(element) || !prop->decodeFrom(element, value)) {
+			rejected = index;
+			return false;
+		}
+
+		++index;
+		return static_cast<bool>(functor(std::move(value)));
+	});
+
+	return rejected;
+}
+
+/**
+ * @brief Reads newline-delimited JSON from \a in, a batch of up to \a batch_size lines at a time,
+ * and checks the records of each batch concurrently.
+ *
+ * Each record is parsed on the executor and passed to \a visit, along with its slot in the batch,
+ * so \a visit is called from many threads at once, each time with a different slot. Once the
+ * whole batch is visited, \a take is called with each slot in the order of the records on the
+ * calling thread until it returns `false`. Lines of only spaces are skipped.
+ *
+ * @param executor Runs the tasks of each batch; they run on a pool of up to one thread per core if
+ * it is not given.
+ * @throws std::invalid_argument if a record is not valid JSON, once the records before it are
+ * taken. The message tells its line.
+ * @throws The error thrown by \a visit for the first record that failed, the same way.
+ */
+void jsonLines(std::istream& in, std::size_t batch_size, detail::FunctionRef<void(std::size_t slot, Source::Cursor const& record)> visit, detail::FunctionRef<bool(std::size_t slot)> take);
+void jsonLines(std::istream& in, std::size_t batch_size, detail::FunctionRef<void(std::size_t slot, Source::Cursor const& record)> visit, detail::FunctionRef<bool(std::size_t slot)> take, Executor const& executor);
+
+/**
+ * @brief Checks and decodes each record of newline-delimited JSON with the Prop of \a item as
+ * `jsonLines` does, many records at once, and passes the values to \a functor in the order of
+ * the records until it returns `false`.
+ *
+ * @param executor Runs the checks; they run on a pool of up to one thread per core if it is not
+ * given.
+ * @return Index of the first record that is rejected, at which reading stops, or `std::nullopt`
+ * if there is none.
+ */
+template<std::derived_from<detail::Prop> P, typename F>
+    requires(std::derived_from<P, detail::CodecProp<typename P::StorageType>>)
+std::optional<std::size_t> decodeJsonLines(std::istream& in, detail::Describer<P> const& item, F&& functor, Executor const& executor = nullptr) {
+	using V = typename P::StorageType;
+
+	constexpr std::size_t BatchSize = 1024;
+
+	auto const prop = detail::getProp(item);
+
+	// Empty for a rejected record.
+	std::vector<std::optional<V>> values(BatchSize);
+
+	std::size_t                index = 0;
+	std::optional<std::size_t> rejected;
+
+	auto const visit = [&](std::size_t slot, Source::Cursor const& record) {
+		V value;
+		if(prop->okFrom(record) && prop->decodeFrom(record, value)) {
+			values[slot] = std::move(value);
+		} else {
+			values[slot].reset();
+		}
+	};
+	auto const take = [&](std::size_t slot) {
+		if(!values[slot].has_value()) {
+			rejected = index;
+			return false;
+		}
+
+		++index;
+		return static_cast<bool>(functor(std::move(*values[slot])));
+	};
+
+	if(executor) {
+		jsonLines(in, BatchSize, visit, take, executor);
+	} else {
+		jsonLines(in, BatchSize, visit, take);
+	}
+
+	return rejected;
+}
+
+/**
+ * @brief Maps the binary snapshot at \a path into memory and reads it in place.
+ *
+ * @throws std::system_error if the file cannot be read.
+ * @throws std::invalid_argument if the file is not a valid snapshot.
+ */
+std::shared_ptr<Source> fromBinary(std::filesystem::path const& path);
+
+/**
+ * @brief Loads \a paths concurrently with the loader registered as \a name and merges them with
+ * `Source::overlay`, each file over the ones before it, regardless of which finishes first.
+ *
+ * @param executor Runs the load of each file; they run on a pool of up to one thread per core if
+ * it is not given.
+ * @return nullptr if there is no such loader.
+ * @throws std::invalid_argument if \a paths is empty.
+ * @throws The error of the first file in \a paths that failed to load, once all are done.
+ */
+std::shared_ptr<Source> fromFiles(std::string const& name, std::vector<std::filesystem::path> const& paths);
+std::shared_ptr<Source> fromFiles(std::string const& name, std::vector<std::filesystem::path> const& paths, Executor const& executor);
+
 }  // namespace load
 
 }  // namespace cray
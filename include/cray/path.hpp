@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cray/source.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+/**
+ * @brief Sequence of References parsed once and resolved against any Source.
+ *
+ * Each level remembers where its key was found the last time, so resolving the same Path again,
+ * against the same document or a reloaded one of the same shape, tests that position first
+ * instead of scanning the map. Since the hints are updated on every resolution, a Path must not be
+ * resolved by multiple threads at once; copy it instead.
+ */
+class Path {
+   public:
+	using const_iterator = std::vector<Reference>::const_iterator;
+
+	Path() = default;
+
+	Path(std::vector<Reference> refs);
+
+	Path(std::initializer_list<Reference> refs)
+	    : Path(std::vector<Reference>(refs)) { }
+
+	/**
+	 * @brief Parses JSON Pointer if \a path is empty or starts with `/`, dotted syntax otherwise.
+	 */
+	static Path parse(std::string_view path);
+
+	/**
+	 * @brief Parses JSON Pointer (RFC 6901), e.g. `/server/tls/ciphers/2`.
+	 *
+	 * A token of digits without leading zeros becomes an index.
+	 *
+	 * @throw std::invalid_argument If \a pointer is not a valid JSON Pointer.
+	 */
+	static Path fromPointer(std::string_view pointer);
+
+	/**
+	 * @brief Parses dotted syntax, e.g. `server.tls.ciphers[2]`.
+	 *
+	 * Keys are separated by `.` and indices are enclosed in `[]`.
+	 *
+	 * @throw std::invalid_argument If \a path is malformed.
+	 */
+	static Path fromDotted(std::string_view path);
+
+	inline std::size_t size() const {
+		return this->refs_.size();
+	}
+
+	inline bool empty() const {
+		return this->refs_.empty();
+	}
+
+	inline Reference const& operator[](std::size_t n) const {
+		return this->refs_[n];
+	}
+
+	inline const_iterator begin() const {
+		return this->refs_.cbegin();
+	}
+
+	inline const_iterator end() const {
+		return this->refs_.cend();
+	}
+
+	/**
+	 * @brief JSON Pointer representation.
+	 */
+	std::string pointer() const;
+
+	/**
+	 * @brief Navigates \a src along this Path.
+	 *
+	 * An index also matches the key of a map spelled with the same digits, since JSON Pointer
+	 * cannot tell them apart.
+	 *
+	 * @return Cursor at the end of the Path or an invalid Cursor if any level is missing.
+	 */
+	Source::Cursor resolve(Source::Cursor const& src) const;
+
+	bool operator==(Path const& other) const;
+
+   private:
+	std::vector<Reference> refs_;
+
+	mutable std::vector<std::size_t> hints_;
+};
+
+}  // namespace cray
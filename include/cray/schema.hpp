@@ -0,0 +1,111 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cray/detail/interval.hpp"
+#include "cray/detail/prop.hpp"
+#include "cray/source.hpp"
+#include "cray/symbol.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+class Loader;
+
+/**
+ * @brief Prop tree compiled to check documents while they are parsed.
+ *
+ * A document passes if the Prop would accept it through `okFrom`. Checking stops at the first
+ * node that is rejected, and a document is never built: the loader hands each node to the
+ * schema as soon as it is read. The Prop tree is compiled once; Props described after the
+ * Schema is made are not checked.
+ */
+class Schema {
+   public:
+	template<std::derived_from<detail::Prop> P>
+	Schema(detail::Describer<P> const& describer)
+	    : Schema(std::shared_ptr<detail::Prop const>(detail::getProp(describer))) { }
+
+	explicit Schema(std::shared_ptr<detail::Prop const> prop);
+
+	bool check(Source::Cursor const& src) const;
+
+	bool check(Loader& loader, std::istream& in) const;
+
+	/**
+	 * @brief Checks the document read from \a in by the loader registered as \a name.
+	 *
+	 * @throws std::invalid_argument if there is no such loader.
+	 */
+	bool check(std::string const& name, std::istream& in) const;
+
+	/**
+	 * @brief Loads only the parts of the document read from \a in that the Prop tree reads.
+	 *
+	 * An entry of a map whose keys are all described, e.g. a structured one, is left out unless
+	 * its key is described, and the loader may skip over it without parsing it. Maps of any key,
+	 * e.g. mono maps, are loaded in full. The document is not checked, and Props described after
+	 * the Schema is made find nothing in it.
+	 */
+	std::shared_ptr<Source> load(Loader& loader, std::istream& in) const;
+
+	/**
+	 * @brief Same as `load(loader, in)` with the loader registered as \a name.
+	 *
+	 * @throws std::invalid_argument if there is no such loader.
+	 */
+	std::shared_ptr<Source> load(std::string const& name, std::istream& in) const;
+
+   private:
+	class Checker;
+	class Builder;
+
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+	struct Key {
+		Symbol key;
+
+		// Rule of the value, or `npos` if the value is not checked.
+		std::size_t rule;
+
+		bool is_ok_if_absent;
+	};
+
+	struct Rule {
+		detail::Prop const* prop;
+
+		Type type;
+
+		// Result for a missing node or a node that is not of `type`.
+		bool is_ok_if_absent;
+
+		// Keys of a map that are checked when the map ends.
+		std::vector<Key> keys;
+
+		// Whether a map is read only through `keys`, so other entries can be left out.
+		bool is_closed = false;
+
+		// Rule of every element of a list.
+		std::size_t item = npos;
+
+		detail::Interval<std::size_t> size = detail::Interval<std::size_t>::All();
+	};
+
+	std::size_t compile_(detail::Prop const& prop);
+
+	/**
+	 * @return Position of \a key in the keys of \a rule, or `npos` if it is not one of them.
+	 */
+	std::size_t find_(std::size_t rule, std::string_view key) const;
+
+	std::shared_ptr<detail::Prop const> prop_;
+	std::vector<Rule>                   rules_;
+};
+
+}  // namespace cray
@@ -1,18 +1,42 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <initializer_list>
 #include <iosfwd>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+#include "cray/detail/function_ref.hpp"
 #include "cray/types.hpp"
 
 namespace cray {
 
+class Dom;
+
+/**
+ * @brief Measurements of a single load.
+ */
+struct LoadStats {
+	// Size of the input in bytes.
+	std::size_t bytes = 0;
+
+	// Time spent in the loader, excluding opening the input.
+	std::chrono::nanoseconds elapsed{0};
+
+	/**
+	 * @return Bytes parsed per second, or 0 if no time was measured.
+	 */
+	double throughput() const;
+};
+
 /**
  * @brief Access to underlying data.
  * 
@@ -37,12 +61,84 @@ class Source {
 		std::shared_ptr<Source> source;
 	};
 
+	class Cursor;
+
+	/**
+	 * @brief Opaque position of a node within a Source, interpreted only by that Source.
+	 */
+	using Handle = std::uintptr_t;
+
 	static std::shared_ptr<Source> null();
 	static std::shared_ptr<Source> make(Entry entry);
 
+	/**
+	 * @brief Source that reads and writes \a dom in place.
+	 *
+	 * @param dom Document to access; shared by every Source navigated from the returned one.
+	 * @return Source at the root of \a dom.
+	 */
+	static std::shared_ptr<Source> fromDom(std::shared_ptr<Dom> dom);
+
+	/**
+	 * @brief Immutable copy of \a source that is edited by path copying.
+	 *
+	 * A write through the returned Source, or through any Source navigated from it, creates new
+	 * nodes only on the path to the written one and shares every other subtree with the previous
+	 * version. Use `snapshot` to keep a version; it costs O(1).
+	 */
+	static std::shared_ptr<Source> persistent(Source const& source);
+
+	/**
+	 * @brief Stacks \a layers without copying them; a node of an upper layer wins over the same
+	 * node of the layers below.
+	 *
+	 * Maps are merged by key and lists by index with the layers right below them that hold a
+	 * container of the same type. Any other node hides the layers below it. Nodes are resolved
+	 * lazily, when they are first accessed. Writes go to the top layer.
+	 *
+	 * @param layers Sources ordered from the bottom, e.g. defaults, file, environment, overrides.
+	 * @throws std::invalid_argument if \a layers is empty or holds nullptr.
+	 */
+	static std::shared_ptr<Source> overlay(std::vector<std::shared_ptr<Source>> layers);
+
+	/**
+	 * @brief Read-only Source over a snapshot written by `dump::asBinary`, read in place.
+	 *
+	 * Every offset in \a data is checked once here; navigating the returned Source allocates
+	 * nothing but the strings it returns. Writes throw `detail::InvalidAccessError`.
+	 *
+	 * @param data Snapshot aligned to 8 bytes. It must outlive the returned Source.
+	 * @param owner Kept alive by the returned Source, e.g. the mapping of \a data.
+	 * @throws std::invalid_argument if \a data is not a valid snapshot.
+	 */
+	static std::shared_ptr<Source> fromBinary(std::span<std::byte const> data, std::shared_ptr<void const> owner = nullptr);
+
 	static std::shared_ptr<Source> load(std::string const& name, std::istream& in);
+
+	/**
+	 * @brief Loads the file at \a path with the loader registered as \a name.
+	 *
+	 * A regular file is memory-mapped and handed to the loader as a buffer; other files, e.g.
+	 * pipes, are read into memory first.
+	 *
+	 * @return nullptr if there is no such loader.
+	 * @throws std::system_error if the file cannot be read.
+	 */
 	static std::shared_ptr<Source> load(std::string const& name, std::filesystem::path const& path);
 
+	/**
+	 * @brief Same as `load(name, path)` but also measures the load into \a stats.
+	 */
+	static std::shared_ptr<Source> load(std::string const& name, std::filesystem::path const& path, LoadStats& stats);
+
+	/**
+	 * @brief Parses \a data held in memory with the loader registered as \a name.
+	 *
+	 * @return nullptr if there is no such loader.
+	 */
+	static std::shared_ptr<Source> parse(std::string const& name, std::string_view data);
+	static std::shared_ptr<Source> parse(std::string const& name, std::span<std::byte const> data);
+
 	virtual ~Source() { }
 
 	virtual std::shared_ptr<Source> next(Reference&& ref)            = 0;
@@ -58,6 +154,12 @@ class Source {
 		});
 	}
 
+	/**
+	 * @brief Visits children of a map together with their keys in one pass. Stops if \a functor
+	 * returns false.
+	 */
+	virtual void entries(detail::FunctionRef<bool(std::string const& key, std::shared_ptr<Source> const& next)> functor) const;
+
 	virtual std::size_t size() const = 0;
 
 	inline bool isEmpty() const {
@@ -80,13 +182,241 @@ class Source {
 	virtual void set(StorageOf<Type::Num> value)        = 0;
 	virtual void set(StorageOf<Type::Str> const& value) = 0;
 	virtual void set(StorageOf<Type::Str>&& value)      = 0;
+
+	/**
+	 * @brief Copy of this node that later writes through this Source do not affect.
+	 *
+	 * The default makes a `persistent` copy of the subtree. Persistent Sources share their nodes
+	 * with the snapshot instead of copying them.
+	 */
+	virtual std::shared_ptr<Source> snapshot() const;
+
+   protected:
+	// Read-only access to the node at \a handle used by Cursor. Defaults ignore the handle
+	// and forward to the shared_ptr API, so a Source that does not override them is navigated
+	// by owning cursors.
+
+	virtual Handle handle_() const {
+		return 0;
+	}
+
+	virtual Cursor nextAt_(Handle handle, Reference const& ref) const;
+
+	/**
+	 * @brief Same as `nextAt_(handle, ref)` but tests the child at position \a hint first and
+	 * stores the position where the child was found back into \a hint.
+	 */
+	virtual Cursor nextAt_(Handle handle, Reference const& ref, std::size_t& hint) const;
+
+	virtual void keysAt_(Handle handle, std::function<bool(std::string const& key)> const& functor) const;
+
+	virtual void entriesAt_(Handle handle, detail::FunctionRef<bool(std::string const& key, Cursor const& next)> functor) const;
+
+	virtual std::size_t sizeAt_(Handle handle) const;
+
+	virtual bool hasAt_(Handle handle, Reference const& ref) const;
+
+	virtual bool isAt_(Handle handle, Type type) const;
+
+	/**
+	 * @brief Address that identifies the storage of the node at \a handle, or nullptr if the
+	 * Source cannot tell. Nodes with the same non-null address hold the same subtree.
+	 */
+	virtual void const* addressAt_(Handle handle) const {
+		return nullptr;
+	}
+
+	virtual bool getAt_(Handle handle, StorageOf<Type::Nil> value) const;
+	virtual bool getAt_(Handle handle, StorageOf<Type::Bool>& value) const;
+	virtual bool getAt_(Handle handle, StorageOf<Type::Int>& value) const;
+	virtual bool getAt_(Handle handle, StorageOf<Type::Num>& value) const;
+	virtual bool getAt_(Handle handle, StorageOf<Type::Str>& value) const;
+
+	virtual bool getAt_(Handle handle, std::span<StorageOf<Type::Int>> values) const;
+	virtual bool getAt_(Handle handle, std::span<StorageOf<Type::Num>> values) const;
+};
+
+/**
+ * @brief Read-only position in a Source that is navigated by value.
+ *
+ * A Source that overrides the `*At_` accessors is navigated without allocating; a Cursor then
+ * borrows the Source, which must outlive it. Otherwise each step holds the Source returned by
+ * `Source::next`. A default constructed Cursor refers to nothing: it is empty, is of no type, and
+ * every `get` fails.
+ */
+class Source::Cursor {
+   public:
+	Cursor() = default;
+
+	Cursor(Source const& source)
+	    : source_(&source)
+	    , handle_(source.handle_()) { }
+
+	Cursor(std::shared_ptr<Source const> source)
+	    : source_(source.get())
+	    , handle_(source ? source->handle_() : 0)
+	    , owner_(std::move(source)) { }
+
+	/**
+	 * @brief Cursor at the node of \a source referred by \a handle. Used by Source
+	 * implementations.
+	 */
+	Cursor(Source const& source, Handle handle)
+	    : source_(&source)
+	    , handle_(handle) { }
+
+	explicit operator bool() const {
+		return this->source_ != nullptr;
+	}
+
+	/**
+	 * @return Cursor at the child or an invalid Cursor if there is no such child.
+	 */
+	inline Cursor next(Reference const& ref) const {
+		if(this->source_ == nullptr) {
+			return Cursor();
+		}
+
+		return this->source_->nextAt_(this->handle_, ref);
+	}
+
+	/**
+	 * @brief Same as `next(ref)` but uses \a hint, a position remembered from a previous lookup,
+	 * to find the child faster.
+	 */
+	inline Cursor next(Reference const& ref, std::size_t& hint) const {
+		if(this->source_ == nullptr) {
+			return Cursor();
+		}
+
+		return this->source_->nextAt_(this->handle_, ref, hint);
+	}
+
+	inline void keys(std::function<bool(std::string const& key)> const& functor) const {
+		if(this->source_ == nullptr) {
+			return;
+		}
+
+		this->source_->keysAt_(this->handle_, functor);
+	}
+
+	/**
+	 * @brief Visits children of a map together with their keys in one pass. Stops if \a functor
+	 * returns false.
+	 */
+	inline void entries(detail::FunctionRef<bool(std::string const& key, Cursor const& next)> functor) const {
+		if(this->source_ == nullptr) {
+			return;
+		}
+
+		this->source_->entriesAt_(this->handle_, functor);
+	}
+
+	inline std::size_t size() const {
+		if(this->source_ == nullptr) {
+			return 0;
+		}
+
+		return this->source_->sizeAt_(this->handle_);
+	}
+
+	inline bool isEmpty() const {
+		return this->size() == 0;
+	}
+
+	inline bool has(Reference const& ref) const {
+		if(this->source_ == nullptr) {
+			return false;
+		}
+
+		return this->source_->hasAt_(this->handle_, ref);
+	}
+
+	inline bool is(Type type) const {
+		if(this->source_ == nullptr) {
+			return false;
+		}
+
+		return this->source_->isAt_(this->handle_, type);
+	}
+
+	/**
+	 * @brief Type of the node, or `Type::Unspecified` if there is no node. A scalar of a text
+	 * format that can be read as several types is of the most specific one, e.g. `Type::Int`
+	 * rather than `Type::Str`.
+	 */
+	Type type() const;
+
+	// clang-format off
+	inline bool get(StorageOf<Type::Nil>   value) const { return this->get_(value); }
+	inline bool get(StorageOf<Type::Bool>& value) const { return this->get_(value); }
+	inline bool get(StorageOf<Type::Int>&  value) const { return this->get_(value); }
+	inline bool get(StorageOf<Type::Num>&  value) const { return this->get_(value); }
+	inline bool get(StorageOf<Type::Str>&  value) const { return this->get_(value); }
+	// clang-format on
+
+	/**
+	 * @brief Reads every element of a list into \a values at once.
+	 *
+	 * @return `false` if this is not a list of `values.size()` elements of the type. \a values
+	 * may be partially written in that case.
+	 */
+	inline bool get(std::span<StorageOf<Type::Int>> values) const {
+		return this->get_(values);
+	}
+
+	inline bool get(std::span<StorageOf<Type::Num>> values) const {
+		return this->get_(values);
+	}
+
+	/**
+	 * @brief Address of the storage of this node, or nullptr if unknown. Two Cursors with the same
+	 * non-null address refer to the same subtree, e.g. one shared between snapshots.
+	 */
+	inline void const* address() const {
+		if(this->source_ == nullptr) {
+			return nullptr;
+		}
+
+		return this->source_->addressAt_(this->handle_);
+	}
+
+	inline Source const* source() const {
+		return this->source_;
+	}
+
+	inline Handle handle() const {
+		return this->handle_;
+	}
+
+   private:
+	template<typename V>
+	bool get_(V& value) const {
+		if(this->source_ == nullptr) {
+			return false;
+		}
+
+		return this->source_->getAt_(this->handle_, value);
+	}
+
+	Source const* source_ = nullptr;
+	Handle        handle_ = 0;
+
+	// Set only if the Source cannot be navigated by handles.
+	std::shared_ptr<Source const> owner_;
 };
 
 namespace detail {
 
 inline auto HeldBy(Source const& source) {
-	return [&](std::string const& key) {
-		return source.has(key);
+	return [&](Reference const& ref) {
+		return source.has(ref);
+	};
+}
+
+inline auto HeldBy(Source::Cursor const& source) {
+	return [&](Reference const& ref) {
+		return source.has(ref);
 	};
 }
 
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace cray {
+
+/**
+ * @brief Key interned in a process-wide table.
+ *
+ * Symbols of equal strings refer to the same entry, so comparing them is a pointer compare and
+ * hashing them reads a precomputed hash. An entry is counted by the Symbols that refer to it and
+ * is released from the table with the last of them, so keys of a document do not outlive it.
+ */
+class Symbol {
+   public:
+	/**
+	 * @brief Symbol of the empty string.
+	 */
+	Symbol();
+
+	Symbol(std::string_view value);
+
+	Symbol(std::string const& value)
+	    : Symbol(std::string_view(value)) { }
+
+	Symbol(char const* value)
+	    : Symbol(std::string_view(value)) { }
+
+	Symbol(Symbol const& other)
+	    : entry_(other.entry_) {
+		Symbol::acquire_(this->entry_);
+	}
+
+	/**
+	 * @brief Takes the entry of \a other without counting, leaving \a other the empty Symbol.
+	 */
+	Symbol(Symbol&& other) noexcept
+	    : entry_(std::exchange(other.entry_, Symbol::empty_())) { }
+
+	~Symbol() {
+		Symbol::release_(this->entry_);
+	}
+
+	Symbol& operator=(Symbol const& other) {
+		Symbol::acquire_(other.entry_);
+		Symbol::release_(this->entry_);
+
+		this->entry_ = other.entry_;
+		return *this;
+	}
+
+	Symbol& operator=(Symbol&& other) noexcept {
+		if(this != &other) {
+			Symbol::release_(this->entry_);
+			this->entry_ = std::exchange(other.entry_, Symbol::empty_());
+		}
+
+		return *this;
+	}
+
+	/**
+	 * @brief Symbol of \a value if it is already interned. Does not intern \a value.
+	 */
+	static std::optional<Symbol> find(std::string_view value);
+
+	inline std::string const& str() const {
+		return this->entry_->value;
+	}
+
+	inline std::size_t hash() const {
+		return this->entry_->hash;
+	}
+
+	/**
+	 * @brief Sequential number given in order of interning. A string released and interned again
+	 * gets a new one.
+	 */
+	inline std::uint32_t id() const {
+		return this->entry_->id;
+	}
+
+	inline bool operator==(Symbol const& other) const {
+		return this->entry_ == other.entry_;
+	}
+
+   private:
+	struct Entry {
+		std::string   value;
+		std::size_t   hash;
+		std::uint32_t id;
+
+		// Number of Symbols that refer to the entry.
+		mutable std::atomic<std::size_t> count;
+
+		// Whether the entry is never released, so its Symbols are not counted. Only the empty
+		// string is.
+		bool is_pinned = false;
+	};
+
+	/**
+	 * @param entry Entry whose count is already incremented for this Symbol.
+	 */
+	Symbol(Entry const* entry)
+	    : entry_(entry) { }
+
+	struct Table;
+
+	/**
+	 * @return Entry of \a value with its count incremented, or nullptr if it is not interned and
+	 * \a insert is false.
+	 */
+	static Entry const* intern_(std::string_view value, bool insert);
+
+	/**
+	 * @return Entry of the empty string.
+	 */
+	static Entry const* empty_() noexcept;
+
+	static void acquire_(Entry const* entry) {
+		if(!entry->is_pinned) {
+			entry->count.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	static void release_(Entry const* entry) {
+		if(!entry->is_pinned && entry->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			Symbol::erase_(entry);
+		}
+	}
+
+	/**
+	 * @brief Removes \a entry, whose count dropped to zero, from the table.
+	 */
+	static void erase_(Entry const* entry);
+
+	Entry const* entry_;
+};
+
+std::ostream& operator<<(std::ostream& o, Symbol const& symbol);
+
+}  // namespace cray
+
+template<>
+struct std::hash<cray::Symbol> {
+	std::size_t operator()(cray::Symbol const& symbol) const noexcept {
+		return symbol.hash();
+	}
+};
@@ -3,6 +3,7 @@
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <optional>
 #include <stdexcept>
 #include <string>
@@ -10,6 +11,8 @@
 #include <utility>
 #include <variant>
 
+#include "cray/symbol.hpp"
+
 namespace cray {
 
 enum class Type {
@@ -112,6 +115,10 @@ struct Key {
 	bool is_required = false;
 };
 
+/**
+ * @brief Index of a list or key of a map. Keys are held as interned Symbols so copying and
+ * comparing a key-Reference does not touch the string.
+ */
 class Reference {
    public:
 	template<typename V>
@@ -128,28 +135,39 @@ class Reference {
 	Reference(int value)
 	    : storage_(static_cast<std::size_t>(value)) { }
 
-	Reference(std::string value)
-	    : storage_(std::move(value)) { }
+	Reference(std::string const& value)
+	    : storage_(Symbol(value)) { }
 
 	Reference(char const* value)
-	    : storage_(std::string(value)) { }
+	    : storage_(Symbol(value)) { }
+
+	Reference(Symbol value)
+	    : storage_(value) { }
 
 	bool isIndex() const {
 		return std::holds_alternative<std::size_t>(storage_);
 	}
 
 	bool isKey() const {
-		return std::holds_alternative<std::string>(storage_);
+		return std::holds_alternative<Symbol>(storage_);
 	}
 
+	/**
+	 * @brief Invokes \a visitor with either the index or the key as `std::string const&`.
+	 */
 	template<typename R, typename F>
 	R visit(F&& visitor) const {
-		return std::visit(std::forward<F>(visitor), this->storage_);
+		if(this->isIndex()) {
+			return std::invoke(std::forward<F>(visitor), this->index());
+		} else {
+			return std::invoke(std::forward<F>(visitor), this->key());
+		}
 	}
 
 	template<typename F>
 	auto visit(F&& visitor) const {
-		return std::visit(std::forward<F>(visitor), this->storage_);
+		using R = std::invoke_result_t<F, std::size_t const&>;
+		return this->visit<R>(std::forward<F>(visitor));
 	}
 
 	std::size_t index() const {
@@ -157,19 +175,19 @@ class Reference {
 	}
 
 	std::string const& key() const& {
-		return std::get<std::string>(storage_);
+		return std::get<Symbol>(storage_).str();
 	}
 
-	std::string const& key() & {
-		return std::get<std::string>(storage_);
+	std::string key() && {
+		return std::get<Symbol>(storage_).str();
 	}
 
-	std::string&& key() && {
-		return std::move(std::get<std::string>(storage_));
+	Symbol symbol() const {
+		return std::get<Symbol>(storage_);
 	}
 
    private:
-	std::variant<std::size_t, std::string> storage_;
+	std::variant<std::size_t, Symbol> storage_;
 };
 
 }  // namespace cray
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cray/source.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+/**
+ * @brief Sink of a document given as a stream of events in document order.
+ *
+ * A value in a map must be preceded by its `key`. Containers are closed in the reverse order they
+ * are opened.
+ */
+class Writer {
+   public:
+	virtual ~Writer() { }
+
+	virtual void beginMap() = 0;
+	virtual void endMap()   = 0;
+
+	virtual void beginList() = 0;
+	virtual void endList()   = 0;
+
+	virtual void key(std::string_view key) = 0;
+
+	// clang-format off
+	virtual void value(StorageOf<Type::Nil>  value) = 0;
+	virtual void value(StorageOf<Type::Bool> value) = 0;
+	virtual void value(StorageOf<Type::Int>  value) = 0;
+	virtual void value(StorageOf<Type::Num>  value) = 0;
+	virtual void value(std::string_view      value) = 0;
+	// clang-format on
+
+	inline void value(char const* value) {
+		this->value(std::string_view(value));
+	}
+
+	/**
+	 * @brief Whether the value of \a key is wanted. Asked before the key of each map entry; if
+	 * not, the entry is left out and a loader may skip over it without parsing it. The default
+	 * wants every entry.
+	 */
+	virtual bool wants(std::string_view key);
+
+	/**
+	 * @brief Writes the scalar at \a src. Loaders of formats whose scalars can be read as several
+	 * types pass them this way; the default writes a string as such, and otherwise the value of the
+	 * most specific type.
+	 */
+	virtual void scalar(Source::Cursor const& src);
+
+	/**
+	 * @brief Writes the subtree at \a src. A node of no type, e.g. a hole in a list, is written as
+	 * `nil`.
+	 */
+	void write(Source::Cursor const& src);
+};
+
+/**
+ * @brief Writer that formats text into an internal buffer and hands it to the stream in large
+ * chunks. The rest is flushed on destruction.
+ */
+class TextWriter: public Writer {
+   public:
+	TextWriter(std::ostream& dst);
+
+	~TextWriter() override;
+
+	void flush();
+
+   protected:
+	void put_(std::string_view text);
+	void put_(char c);
+	void put_(StorageOf<Type::Int> value);
+
+	/**
+	 * @brief Writes the shortest representation of a finite \a value that reads back as a
+	 * floating point number.
+	 */
+	void put_(StorageOf<Type::Num> value);
+
+	void indent_(std::size_t width);
+
+   private:
+	std::ostream& dst_;
+	std::string   buffer_;
+};
+
+/**
+ * @brief Writes block style YAML.
+ */
+class YamlWriter: public TextWriter {
+   public:
+	using TextWriter::TextWriter;
+
+	using Writer::value;
+
+	void beginMap() override;
+	void endMap() override;
+
+	void beginList() override;
+	void endList() override;
+
+	void key(std::string_view key) override;
+
+	// clang-format off
+	void value(StorageOf<Type::Nil>  value) override;
+	void value(StorageOf<Type::Bool> value) override;
+	void value(StorageOf<Type::Int>  value) override;
+	void value(StorageOf<Type::Num>  value) override;
+	void value(std::string_view      value) override;
+	// clang-format on
+
+	/**
+	 * @brief Writes a string that reads as another scalar type as well as its text, unquoted, so
+	 * it reads back the same way.
+	 */
+	void scalar(Source::Cursor const& src) override;
+
+	std::size_t tab_size = 2;
+
+   private:
+	struct Frame {
+		Type        type;
+		std::size_t size;
+
+		// Column of the children.
+		std::size_t indent;
+
+		// Whether the first child goes on the line of the list item holding the container.
+		bool is_inline;
+	};
+
+	void begin_(Type type);
+	void end_();
+
+	/**
+	 * @brief Starts a line of the next child of the innermost container.
+	 */
+	void item_();
+
+	/**
+	 * @brief Prepares to write a scalar where a value is expected.
+	 */
+	void scalar_();
+
+	void str_(std::string_view value);
+
+	void done_();
+
+	std::vector<Frame> frames_;
+
+	// Whether anything is written on the current line.
+	bool is_line_open_ = false;
+};
+
+/**
+ * @brief Writes indented JSON.
+ */
+class JsonWriter: public TextWriter {
+   public:
+	using TextWriter::TextWriter;
+
+	using Writer::value;
+
+	void beginMap() override;
+	void endMap() override;
+
+	void beginList() override;
+	void endList() override;
+
+	void key(std::string_view key) override;
+
+	// clang-format off
+	void value(StorageOf<Type::Nil>  value) override;
+	void value(StorageOf<Type::Bool> value) override;
+	void value(StorageOf<Type::Int>  value) override;
+	void value(StorageOf<Type::Num>  value) override;
+	void value(std::string_view      value) override;
+	// clang-format on
+
+	/**
+	 * @brief Writes a string that reads as another scalar type as well as its text, unquoted, if
+	 * the text is a JSON number or boolean; otherwise as a string.
+	 */
+	void scalar(Source::Cursor const& src) override;
+
+	std::size_t tab_size = 2;
+
+   private:
+	void begin_(char c);
+	void end_(char c);
+
+	/**
+	 * @brief Starts the next child of the innermost container unless it follows a key.
+	 */
+	void item_();
+
+	void str_(std::string_view value);
+
+	void done_();
+
+	// Number of children of each open container.
+	std::vector<std::size_t> sizes_;
+
+	bool is_after_key_ = false;
+};
+
+}  // namespace cray
@@ -0,0 +1,708 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cray/detail/function_ref.hpp"
+#include "cray/detail/mapped_file.hpp"
+#include "cray/dump.hpp"
+#include "cray/load.hpp"
+#include "cray/source.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+namespace {
+
+// A binary snapshot is laid out as
+//
+//     Header | Node[header.nodes] | Slot[header.slots] | char[header.bytes]
+//
+// in the byte order of the host that wrote it. The root is the first node. Containers refer to a
+// contiguous range of slots; strings and keys refer to a range of the byte pool. Everything is
+// referred to by offset, so the snapshot is read in place.
+//
+// A string that reads as other scalar types as well, e.g. a plain YAML scalar, keeps its text and
+// is flagged with the types it reads as. Those readings follow the text in the byte pool, in the
+// order of the flags.
+
+constexpr char          Magic[8] = {'C', 'R', 'a', 'y', 'B', 'i', 'n', '\0'};
+constexpr std::uint32_t Version  = 1;
+constexpr std::uint32_t Endian   = 0x01020304;
+
+struct Header {
+	char          magic[8];
+	std::uint32_t version;
+	std::uint32_t endian;
+	std::uint64_t nodes;
+	std::uint64_t slots;
+	std::uint64_t bytes;
+};
+
+// clang-format off
+constexpr std::uint8_t AsInt  = 1 << 0;
+constexpr std::uint8_t AsNum  = 1 << 1;
+constexpr std::uint8_t AsBool = 1 << 2;
+// clang-format on
+
+struct Node {
+	std::uint8_t  type;
+	std::uint8_t  flags;
+	std::uint8_t  reserved[2];
+	std::uint32_t size;
+
+	// Boolean, integer, bits of a number, offset into the byte pool for a string, or index of the
+	// first slot for a container.
+	std::uint64_t value;
+};
+
+struct Slot {
+	// Key of a map child; empty for a list.
+	std::uint64_t key_offset;
+	std::uint32_t key_size;
+
+	std::uint32_t node;
+};
+
+/**
+ * @brief Number of bytes of the readings of a string flagged with \a flags.
+ */
+std::size_t readingsSize(std::uint8_t flags) {
+	std::size_t size = 0;
+	if(flags & AsInt) {
+		size += sizeof(StorageOf<Type::Int>);
+	}
+	if(flags & AsNum) {
+		size += sizeof(StorageOf<Type::Num>);
+	}
+	if(flags & AsBool) {
+		size += 1;
+	}
+
+	return size;
+}
+
+static_assert(sizeof(Header) == 40);
+static_assert(sizeof(Node) == 16);
+static_assert(sizeof(Slot) == 16);
+
+class BinaryEncoder {
+   public:
+	void encode(Source::Cursor const& src) {
+		this->add_(src);
+	}
+
+	void writeTo(std::ostream& dst) const {
+		Header header{};
+		std::memcpy(header.magic, Magic, sizeof(Magic));
+		header.version = Version;
+		header.endian  = Endian;
+		header.nodes   = this->nodes_.size();
+		header.slots   = this->slots_.size();
+		header.bytes   = this->bytes_.size();
+
+		dst.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		dst.write(reinterpret_cast<char const*>(this->nodes_.data()), this->nodes_.size() * sizeof(Node));
+		dst.write(reinterpret_cast<char const*>(this->slots_.data()), this->slots_.size() * sizeof(Slot));
+		dst.write(this->bytes_.data(), this->bytes_.size());
+	}
+
+   private:
+	std::uint32_t add_(Source::Cursor const& src) {
+		auto const index = static_cast<std::uint32_t>(this->nodes_.size());
+		this->nodes_.emplace_back();
+
+		// A string is tried first so that the text of a plain scalar, such as `1.10` or `yes` in
+		// YAML, is kept.
+		auto const type = src.is(Type::Str) ? Type::Str : src.type();
+
+		Node node{};
+		node.type = static_cast<std::uint8_t>(type);
+
+		switch(type) {
+		case Type::Map: {
+			std::vector<std::pair<std::string, Source::Cursor>> children;
+			src.entries([&](std::string const& key, Source::Cursor const& next) {
+				children.emplace_back(key, next);
+				return true;
+			});
+
+			node.size  = static_cast<std::uint32_t>(children.size());
+			node.value = this->slots_.size();
+			this->slots_.resize(this->slots_.size() + children.size());
+
+			for(std::size_t i = 0; i < children.size(); ++i) {
+				auto const& [key, next] = children[i];
+
+				auto const [offset, size] = this->key_(key);
+				auto const child          = this->add_(next);
+
+				auto& slot      = this->slots_[node.value + i];
+				slot.key_offset = offset;
+				slot.key_size   = size;
+				slot.node       = child;
+			}
+			break;
+		}
+
+		case Type::List: {
+			std::size_t const size = src.size();
+
+			node.size  = static_cast<std::uint32_t>(size);
+			node.value = this->slots_.size();
+			this->slots_.resize(this->slots_.size() + size);
+
+			for(std::size_t i = 0; i < size; ++i) {
+				auto const child = this->add_(src.next(i));
+
+				this->slots_[node.value + i].node = child;
+			}
+			break;
+		}
+
+		case Type::Bool: {
+			StorageOf<Type::Bool> v = false;
+			src.get(v);
+			node.value = v ? 1 : 0;
+			break;
+		}
+
+		case Type::Int: {
+			StorageOf<Type::Int> v = 0;
+			src.get(v);
+			node.value = static_cast<std::uint64_t>(v);
+			break;
+		}
+
+		case Type::Num: {
+			StorageOf<Type::Num> v = 0;
+			src.get(v);
+			node.value = std::bit_cast<std::uint64_t>(v);
+			break;
+		}
+
+		case Type::Str: {
+			StorageOf<Type::Str> v;
+			src.get(v);
+			node.size  = static_cast<std::uint32_t>(v.size());
+			node.value = this->store_(v);
+
+			// clang-format off
+			if(StorageOf<Type::Int>  u = 0;     src.get(u)) { node.flags |= AsInt;  this->storeRaw_(u); }
+			if(StorageOf<Type::Num>  u = 0;     src.get(u)) { node.flags |= AsNum;  this->storeRaw_(u); }
+			if(StorageOf<Type::Bool> u = false; src.get(u)) { node.flags |= AsBool; this->storeRaw_(static_cast<std::uint8_t>(u)); }
+			// clang-format on
+			break;
+		}
+
+		default:
+			break;
+		}
+
+		this->nodes_[index] = node;
+		return index;
+	}
+
+	std::uint64_t store_(std::string_view value) {
+		auto const offset = this->bytes_.size();
+		this->bytes_.append(value);
+
+		return offset;
+	}
+
+	template<typename V>
+	void storeRaw_(V value) {
+		char raw[sizeof(V)];
+		std::memcpy(raw, &value, sizeof(V));
+		this->store_(std::string_view(raw, sizeof(V)));
+	}
+
+	/**
+	 * @brief Stores each distinct key once.
+	 */
+	std::pair<std::uint64_t, std::uint32_t> key_(std::string const& key) {
+		auto const size = static_cast<std::uint32_t>(key.size());
+
+		auto const it = this->keys_.find(key);
+		if(it != this->keys_.end()) {
+			return {it->second, size};
+		}
+
+		auto const offset = this->store_(key);
+		this->keys_.emplace(key, offset);
+
+		return {offset, size};
+	}
+
+	std::vector<Node> nodes_;
+	std::vector<Slot> slots_;
+	std::string       bytes_;
+
+	std::unordered_map<std::string, std::uint64_t> keys_;
+};
+
+/**
+ * @brief Read-only Source over a binary snapshot held in memory.
+ */
+class BinarySource: public Source {
+   public:
+	static constexpr std::uint32_t npos = static_cast<std::uint32_t>(-1);
+
+	struct Image {
+		std::shared_ptr<void const> owner;
+
+		Node const* nodes;
+		Slot const* slots;
+		char const* bytes;
+	};
+
+	BinarySource(std::shared_ptr<Image const> image, std::uint32_t index)
+	    : image(std::move(image))
+	    , index(index) { }
+
+	std::shared_ptr<Source> next(Reference&& ref) override {
+		return this->next(std::as_const(ref));
+	}
+
+	std::shared_ptr<Source> next(Reference const& ref) override {
+		auto next = std::as_const(*this).next(ref);
+		if(next == nullptr) {
+			return Source::null();
+		}
+
+		return next;
+	}
+
+	std::shared_ptr<Source> next(Reference const& ref) const override {
+		auto const found = this->find_(this->index, ref);
+		if(found == npos) {
+			return nullptr;
+		}
+
+		return std::make_shared<BinarySource>(this->image, found);
+	}
+
+	void keys(std::function<bool(std::string const& key)> const& functor) const override {
+		this->keysAt_(this->index, functor);
+	}
+
+	std::size_t size() const override {
+		return this->sizeAt_(this->index);
+	}
+
+	bool has(Reference const& ref) const override {
+		return this->hasAt_(this->index, ref);
+	}
+
+	bool is(Type type) const override {
+		return this->isAt_(this->index, type);
+	}
+
+	// clang-format off
+	bool get(StorageOf<Type::Nil>   value) const override { return this->getAt_(this->index, value); }
+	bool get(StorageOf<Type::Bool>& value) const override { return this->getAt_(this->index, value); }
+	bool get(StorageOf<Type::Int>&  value) const override { return this->getAt_(this->index, value); }
+	bool get(StorageOf<Type::Num>&  value) const override { return this->getAt_(this->index, value); }
+	bool get(StorageOf<Type::Str>&  value) const override { return this->getAt_(this->index, value); }
+
+	void set(StorageOf<Type::Nil>)        override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Bool>)       override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Int>)        override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Num>)        override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Str> const&) override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Str>&&)      override { throw detail::InvalidAccessError(); }
+	// clang-format on
+
+	std::shared_ptr<Image const> image;
+	std::uint32_t                index;
+
+   protected:
+	// Handles are node indices; `npos` refers to a node that does not exist.
+
+	Handle handle_() const override {
+		return this->index;
+	}
+
+	Cursor nextAt_(Handle handle, Reference const& ref) const override {
+		auto const found = this->find_(handle, ref);
+		if(found == npos) {
+			return Cursor();
+		}
+
+		return Cursor(*this, found);
+	}
+
+	Cursor nextAt_(Handle handle, Reference const& ref, std::size_t& hint) const override {
+		auto const* node = this->node_(handle);
+		if(node == nullptr || ref.isIndex() || node->type != static_cast<std::uint8_t>(Type::Map)) {
+			return this->nextAt_(handle, ref);
+		}
+
+		auto const  key   = std::string_view(ref.key());
+		auto const* first = this->image->slots + node->value;
+		if(hint < node->size && this->keyOf_(first[hint]) == key) {
+			return Cursor(*this, first[hint].node);
+		}
+
+		for(std::size_t i = 0; i < node->size; ++i) {
+			if(this->keyOf_(first[i]) == key) {
+				hint = i;
+				return Cursor(*this, first[i].node);
+			}
+		}
+
+		return Cursor();
+	}
+
+	void keysAt_(Handle handle, std::function<bool(std::string const& key)> const& functor) const override {
+		auto const* node = this->node_(handle);
+		if(node == nullptr || node->type != static_cast<std::uint8_t>(Type::Map)) {
+			return;
+		}
+
+		auto const* first = this->image->slots + node->value;
+		for(std::size_t i = 0; i < node->size; ++i) {
+			if(!functor(std::string(this->keyOf_(first[i])))) {
+				return;
+			}
+		}
+	}
+
+	void entriesAt_(Handle handle, detail::FunctionRef<bool(std::string const& key, Cursor const& next)> functor) const override {
+		auto const* node = this->node_(handle);
+		if(node == nullptr || node->type != static_cast<std::uint8_t>(Type::Map)) {
+			return;
+		}
+
+		std::string key;
+
+		auto const* first = this->image->slots + node->value;
+		for(std::size_t i = 0; i < node->size; ++i) {
+			key.assign(this->keyOf_(first[i]));
+			if(!functor(key, Cursor(*this, first[i].node))) {
+				return;
+			}
+		}
+	}
+
+	std::size_t sizeAt_(Handle handle) const override {
+		auto const* node = this->node_(handle);
+		if(node == nullptr) {
+			return 0;
+		}
+
+		switch(static_cast<Type>(node->type)) {
+		case Type::Map:
+		case Type::List:
+			return node->size;
+
+		default:
+			return 0;
+		}
+	}
+
+	bool hasAt_(Handle handle, Reference const& ref) const override {
+		return this->find_(handle, ref) != npos;
+	}
+
+	bool isAt_(Handle handle, Type type) const override {
+		auto const* node = this->node_(handle);
+		if(node == nullptr || type == Type::Unspecified) {
+			return false;
+		}
+
+		if(node->type == static_cast<std::uint8_t>(type)) {
+			return true;
+		}
+
+		switch(type) {
+		case Type::Bool: return (node->flags & AsBool) != 0;
+		case Type::Int: return (node->flags & AsInt) != 0;
+		case Type::Num: return (node->flags & AsNum) != 0;
+
+		default: return false;
+		}
+	}
+
+	void const* addressAt_(Handle handle) const override {
+		return this->node_(handle);
+	}
+
+	bool getAt_(Handle handle, StorageOf<Type::Nil>) const override {
+		return this->isAt_(handle, Type::Nil);
+	}
+
+	bool getAt_(Handle handle, StorageOf<Type::Bool>& value) const override {
+		auto const* node = this->nodeOf_(handle, Type::Bool);
+		if(node == nullptr) {
+			std::uint8_t u = 0;
+			if(!this->readingAt_(handle, AsBool, u)) {
+				return false;
+			}
+
+			value = u != 0;
+			return true;
+		}
+
+		value = node->value != 0;
+		return true;
+	}
+
+	bool getAt_(Handle handle, StorageOf<Type::Int>& value) const override {
+		auto const* node = this->nodeOf_(handle, Type::Int);
+		if(node == nullptr) {
+			return this->readingAt_(handle, AsInt, value);
+		}
+
+		value = static_cast<StorageOf<Type::Int>>(node->value);
+		return true;
+	}
+
+	bool getAt_(Handle handle, StorageOf<Type::Num>& value) const override {
+		auto const* node = this->nodeOf_(handle, Type::Num);
+		if(node == nullptr) {
+			return this->readingAt_(handle, AsNum, value);
+		}
+
+		value = std::bit_cast<StorageOf<Type::Num>>(node->value);
+		return true;
+	}
+
+	bool getAt_(Handle handle, StorageOf<Type::Str>& value) const override {
+		auto const* node = this->nodeOf_(handle, Type::Str);
+		if(node == nullptr) {
+			return false;
+		}
+
+		value.assign(this->image->bytes + node->value, node->size);
+		return true;
+	}
+
+	bool getAt_(Handle handle, std::span<StorageOf<Type::Int>> values) const override {
+		return this->getAll_(handle, values);
+	}
+
+	bool getAt_(Handle handle, std::span<StorageOf<Type::Num>> values) const override {
+		return this->getAll_(handle, values);
+	}
+
+   private:
+	Node const* node_(Handle handle) const {
+		if(handle == npos) {
+			return nullptr;
+		}
+
+		return this->image->nodes + handle;
+	}
+
+	Node const* nodeOf_(Handle handle, Type type) const {
+		auto const* node = this->node_(handle);
+		if(node == nullptr || node->type != static_cast<std::uint8_t>(type)) {
+			return nullptr;
+		}
+
+		return node;
+	}
+
+	/**
+	 * @brief Reads the reading flagged \a flag of the string at \a handle.
+	 */
+	template<typename V>
+	bool readingAt_(Handle handle, std::uint8_t flag, V& value) const {
+		auto const* node = this->nodeOf_(handle, Type::Str);
+		if(node == nullptr || (node->flags & flag) == 0) {
+			return false;
+		}
+
+		// Readings of the flags before \a flag come first.
+		auto const offset = node->value + node->size + readingsSize(node->flags & (flag - 1));
+		std::memcpy(&value, this->image->bytes + offset, sizeof(V));
+		return true;
+	}
+
+	std::string_view keyOf_(Slot const& slot) const {
+		return std::string_view(this->image->bytes + slot.key_offset, slot.key_size);
+	}
+
+	std::uint32_t find_(Handle handle, Reference const& ref) const {
+		auto const* node = this->node_(handle);
+		if(node == nullptr) {
+			return npos;
+		}
+
+		auto const* first = this->image->slots + node->value;
+		if(ref.isIndex()) {
+			if(node->type != static_cast<std::uint8_t>(Type::List) || ref.index() >= node->size) {
+				return npos;
+			}
+
+			return first[ref.index()].node;
+		}
+
+		if(node->type != static_cast<std::uint8_t>(Type::Map)) {
+			return npos;
+		}
+
+		auto const key = std::string_view(ref.key());
+		for(std::size_t i = 0; i < node->size; ++i) {
+			if(this->keyOf_(first[i]) == key) {
+				return first[i].node;
+			}
+		}
+
+		return npos;
+	}
+
+	template<typename V>
+	bool getAll_(Handle handle, std::span<V> values) const {
+		auto const* node = this->nodeOf_(handle, Type::List);
+		if(node == nullptr || node->size != values.size()) {
+			return false;
+		}
+
+		auto const* first = this->image->slots + node->value;
+		for(std::size_t i = 0; i < values.size(); ++i) {
+			if(!this->getAt_(first[i].node, values[i])) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+/**
+ * @brief Checks that every offset of the snapshot is within \a data so that reading it never goes
+ * out of bounds.
+ */
+void validate(std::span<std::byte const> data) {
+	auto const invalid = [](char const* what) {
+		return std::invalid_argument(std::string("invalid binary snapshot: ") + what);
+	};
+
+	if(reinterpret_cast<std::uintptr_t>(data.data()) % alignof(Node) != 0) {
+		throw std::invalid_argument("binary snapshot must be aligned to 8 bytes");
+	}
+	if(data.size() < sizeof(Header)) {
+		throw invalid("too short");
+	}
+
+	auto const& header = *reinterpret_cast<Header const*>(data.data());
+	if(std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+		throw invalid("bad magic");
+	}
+	if(header.endian != Endian) {
+		throw invalid("written in another byte order");
+	}
+	if(header.version != Version) {
+		throw invalid("unsupported version");
+	}
+
+	auto const rest = data.size() - sizeof(Header);
+	if(header.nodes == 0 || header.nodes > BinarySource::npos || header.nodes > rest / sizeof(Node)) {
+		throw invalid("bad node table");
+	}
+	if(header.slots > (rest - header.nodes * sizeof(Node)) / sizeof(Slot)) {
+		throw invalid("bad slot table");
+	}
+	if(header.bytes != rest - header.nodes * sizeof(Node) - header.slots * sizeof(Slot)) {
+		throw invalid("bad byte pool");
+	}
+
+	auto const* nodes = reinterpret_cast<Node const*>(data.data() + sizeof(Header));
+	auto const* slots = reinterpret_cast<Slot const*>(nodes + header.nodes);
+	for(std::size_t i = 0; i < header.nodes; ++i) {
+		auto const& node = nodes[i];
+		if(node.flags != 0 && (node.type != static_cast<std::uint8_t>(Type::Str) || (node.flags & ~(AsInt | AsNum | AsBool)) != 0)) {
+			throw invalid("bad flags");
+		}
+
+		switch(static_cast<Type>(node.type)) {
+		case Type::Map:
+		case Type::List: {
+			if(node.value > header.slots || node.size > header.slots - node.value) {
+				throw invalid("child table out of range");
+			}
+
+			for(std::size_t j = 0; j < node.size; ++j) {
+				auto const& slot = slots[node.value + j];
+				if(slot.node >= header.nodes) {
+					throw invalid("child out of range");
+				}
+				if(slot.key_offset > header.bytes || slot.key_size > header.bytes - slot.key_offset) {
+					throw invalid("key out of range");
+				}
+			}
+			break;
+		}
+
+		case Type::Str: {
+			auto const size = node.size + readingsSize(node.flags);
+			if(node.value > header.bytes || size > header.bytes - node.value) {
+				throw invalid("string out of range");
+			}
+			break;
+		}
+
+		case Type::Unspecified:
+		case Type::Nil:
+		case Type::Bool:
+		case Type::Int:
+		case Type::Num:
+			break;
+
+		default:
+			throw invalid("unknown type");
+		}
+	}
+}
+
+}  // namespace
+
+std::shared_ptr<Source> Source::fromBinary(std::span<std::byte const> data, std::shared_ptr<void const> owner) {
+	validate(data);
+
+	auto const& header = *reinterpret_cast<Header const*>(data.data());
+
+	auto image   = std::make_shared<BinarySource::Image>();
+	image->owner = std::move(owner);
+	image->nodes = reinterpret_cast<Node const*>(data.data() + sizeof(Header));
+	image->slots = reinterpret_cast<Slot const*>(image->nodes + header.nodes);
+	image->bytes = reinterpret_cast<char const*>(image->slots + header.slots);
+
+	return std::make_shared<BinarySource>(std::move(image), 0);
+}
+
+namespace load {
+
+std::shared_ptr<Source> fromBinary(std::filesystem::path const& path) {
+	auto file = detail::MappedFile::open(path);
+
+	auto const bytes = file->bytes();
+	return Source::fromBinary(bytes, std::move(file));
+}
+
+}  // namespace load
+
+namespace dump {
+
+void asBinary(std::ostream& dst, Source::Cursor const& src) {
+	BinaryEncoder encoder;
+	encoder.encode(src);
+	encoder.writeTo(dst);
+}
+
+}  // namespace dump
+
+}  // namespace cray
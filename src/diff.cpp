@@ -0,0 +1,161 @@
+#include "cray/diff.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cray/detail/function_ref.hpp"
+#include "cray/path.hpp"
+#include "cray/source.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+namespace {
+
+template<typename V>
+bool equals(Source::Cursor const& lhs, Source::Cursor const& rhs) {
+	V l;
+	V r;
+	return lhs.get(l) && rhs.get(r) && l == r;
+}
+
+class Differ {
+   public:
+	Differ(detail::FunctionRef<void(Change change, Path const& path)> functor)
+	    : functor_(functor) { }
+
+	void compare(Source::Cursor const& from, Source::Cursor const& to) {
+		if(auto const* const addr = from.address(); addr != nullptr && addr == to.address()) {
+			return;
+		}
+
+		auto const type = from.type();
+		if(type != to.type()) {
+			this->emit_(Change::Modified);
+			return;
+		}
+
+		switch(type) {
+		case Type::Map: {
+			this->compareMaps_(from, to);
+			return;
+		}
+
+		case Type::List: {
+			this->compareLists_(from, to);
+			return;
+		}
+
+		// clang-format off
+		case Type::Bool: if(!equals<StorageOf<Type::Bool>>(from, to)) { this->emit_(Change::Modified); } return;
+		case Type::Int:  if(!equals<StorageOf<Type::Int>>(from, to))  { this->emit_(Change::Modified); } return;
+		case Type::Num:  if(!equals<StorageOf<Type::Num>>(from, to))  { this->emit_(Change::Modified); } return;
+		case Type::Str:  if(!equals<StorageOf<Type::Str>>(from, to))  { this->emit_(Change::Modified); } return;
+		// clang-format on
+
+		default:
+			return;
+		}
+	}
+
+   private:
+	void compareMaps_(Source::Cursor const& from, Source::Cursor const& to) {
+		std::size_t hint = 0;
+		from.entries([&](std::string const& key, Source::Cursor const& prev) {
+			this->path_.emplace_back(key);
+
+			auto const next = to.next(this->path_.back(), hint);
+			if(next) {
+				this->compare(prev, next);
+			} else {
+				this->emit_(Change::Removed);
+			}
+
+			// Most likely the next key follows it.
+			++hint;
+			this->path_.pop_back();
+			return true;
+		});
+
+		hint = 0;
+		to.entries([&](std::string const& key, Source::Cursor const& next) {
+			this->path_.emplace_back(key);
+			if(!from.next(this->path_.back(), hint)) {
+				this->emit_(Change::Added);
+			}
+
+			++hint;
+			this->path_.pop_back();
+			return true;
+		});
+	}
+
+	void compareLists_(Source::Cursor const& from, Source::Cursor const& to) {
+		std::size_t const size_from = from.size();
+		std::size_t const size_to   = to.size();
+
+		std::size_t i = 0;
+		for(; i < size_from && i < size_to; ++i) {
+			this->path_.emplace_back(i);
+
+			auto const prev = from.next(i);
+			auto const next = to.next(i);
+			if(prev && next) {
+				this->compare(prev, next);
+			} else if(prev) {
+				this->emit_(Change::Removed);
+			} else if(next) {
+				this->emit_(Change::Added);
+			}
+
+			this->path_.pop_back();
+		}
+		for(std::size_t j = i; j < size_from; ++j) {
+			this->path_.emplace_back(j);
+			this->emit_(Change::Removed);
+			this->path_.pop_back();
+		}
+		for(std::size_t j = i; j < size_to; ++j) {
+			this->path_.emplace_back(j);
+			this->emit_(Change::Added);
+			this->path_.pop_back();
+		}
+	}
+
+	void emit_(Change change) {
+		this->functor_(change, Path(this->path_));
+	}
+
+	detail::FunctionRef<void(Change change, Path const& path)> functor_;
+
+	std::vector<Reference> path_;
+};
+
+}  // namespace
+
+void diff(Source::Cursor const& from, Source::Cursor const& to, detail::FunctionRef<void(Change change, Path const& path)> functor) {
+	if(!from && !to) {
+		return;
+	}
+
+	if(!from) {
+		functor(Change::Added, Path());
+	} else if(!to) {
+		functor(Change::Removed, Path());
+	} else {
+		Differ(functor).compare(from, to);
+	}
+}
+
+std::vector<Difference> diff(Source::Cursor const& from, Source::Cursor const& to) {
+	std::vector<Difference> rst;
+	diff(from, to, [&](Change change, Path const& path) {
+		rst.push_back(Difference{.change = change, .path = path});
+	});
+
+	return rst;
+}
+
+}  // namespace cray
@@ -0,0 +1,630 @@
+#include "cray/dom.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "cray/types.hpp"
+
+namespace cray {
+
+namespace {
+
+// Plain strings are read as yaml-cpp's `YAML::convert` reads scalars, but
+// without exceptions or streams since `is` and `get` probe them on every access.
+
+/**
+ * @brief Whether \a text is in lower, upper, or capitalized case, e.g. `true`, `TRUE`, or `True`.
+ */
+bool isFlexibleCase(std::string_view text) {
+	if(text.empty()) {
+		return true;
+	}
+
+	auto const is_lower = [](char c) { return 'a' <= c && c <= 'z'; };
+	auto const is_upper = [](char c) { return 'A' <= c && c <= 'Z'; };
+
+	auto const rest = text.substr(1);
+	if(std::all_of(rest.begin(), rest.end(), is_lower)) {
+		return true;
+	}
+
+	return is_upper(text.front()) && std::all_of(rest.begin(), rest.end(), is_upper);
+}
+
+std::optional<bool> parseBool(std::string_view text) {
+	constexpr std::array<std::pair<std::string_view, bool>, 8> Words{{
+	    {"y", true},
+	    {"n", false},
+	    {"yes", true},
+	    {"no", false},
+	    {"true", true},
+	    {"false", false},
+	    {"on", true},
+	    {"off", false},
+	}};
+
+	// Longest word is "false".
+	if(text.empty() || text.size() > 5 || !isFlexibleCase(text)) {
+		return std::nullopt;
+	}
+
+	char lower[5];
+	for(std::size_t i = 0; i < text.size(); ++i) {
+		auto const c = text[i];
+		lower[i]     = ('A' <= c && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	std::string_view const word(lower, text.size());
+	for(auto const& [w, value]: Words) {
+		if(w == word) {
+			return value;
+		}
+	}
+
+	return std::nullopt;
+}
+
+/**
+ * @brief Parses an integer in decimal, hex with `0x`, or octal with leading `0`, optionally signed.
+ */
+std::optional<StorageOf<Type::Int>> parseInt(std::string_view text) {
+	using Int = StorageOf<Type::Int>;
+
+	bool is_negative = false;
+	if(!text.empty() && (text.front() == '-' || text.front() == '+')) {
+		is_negative = text.front() == '-';
+		text.remove_prefix(1);
+	}
+
+	int base = 10;
+	if(text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+		base = 16;
+		text.remove_prefix(2);
+	} else if(text.size() > 1 && text[0] == '0') {
+		base = 8;
+		text.remove_prefix(1);
+	}
+
+	// `from_chars` takes neither sign nor prefix, so neither can repeat.
+	if(text.empty() || text.front() == '-' || text.front() == '+') {
+		return std::nullopt;
+	}
+
+	std::uintmax_t magnitude = 0;
+
+	auto const* const end = text.data() + text.size();
+	auto const [ptr, ec]  = std::from_chars(text.data(), end, magnitude, base);
+	if(ec != std::errc() || ptr != end) {
+		return std::nullopt;
+	}
+
+	constexpr auto Max = static_cast<std::uintmax_t>(std::numeric_limits<Int>::max());
+	if(is_negative) {
+		if(magnitude > Max + 1) {
+			return std::nullopt;
+		}
+		return magnitude == Max + 1 ? std::numeric_limits<Int>::min() : -static_cast<Int>(magnitude);
+	} else {
+		if(magnitude > Max) {
+			return std::nullopt;
+		}
+		return static_cast<Int>(magnitude);
+	}
+}
+
+std::optional<StorageOf<Type::Num>> parseNum(std::string_view text) {
+	using Num = StorageOf<Type::Num>;
+
+	if(text.empty()) {
+		return std::nullopt;
+	}
+
+	auto const sign = text.front();
+	if(sign == '-' || sign == '+') {
+		text.remove_prefix(1);
+	}
+
+	if(text == ".inf" || text == ".Inf" || text == ".INF") {
+		return sign == '-' ? -std::numeric_limits<Num>::infinity() : std::numeric_limits<Num>::infinity();
+	}
+	if(text == ".nan" || text == ".NaN" || text == ".NAN") {
+		if(sign == '-' || sign == '+') {
+			return std::nullopt;
+		}
+		return std::numeric_limits<Num>::quiet_NaN();
+	}
+
+	// `from_chars` also reads "inf" and "nan", which are strings in YAML, and a second sign.
+	if(text.empty() || !(('0' <= text.front() && text.front() <= '9') || text.front() == '.')) {
+		return std::nullopt;
+	}
+
+	Num value = 0;
+
+	auto const* const end = text.data() + text.size();
+	auto const [ptr, ec]  = std::from_chars(text.data(), end, value);
+	if(ec != std::errc() || ptr != end) {
+		return std::nullopt;
+	}
+
+	return sign == '-' ? -value : value;
+}
+
+template<typename V>
+bool assign(std::optional<V> const& parsed, V& value) {
+	if(!parsed) {
+		return false;
+	}
+
+	value = *parsed;
+	return true;
+}
+
+}  // namespace
+
+Dom::Dom() {
+	this->clear();
+}
+
+void Dom::clear() {
+	this->nodes_.clear();
+	this->slots_.clear();
+	this->bytes_.clear();
+	this->indices_.clear();
+
+	this->make_();
+	this->nodes_[0].type = Type::Nil;
+}
+
+void Dom::reserve(std::size_t nodes, std::size_t bytes) {
+	this->nodes_.reserve(nodes);
+	this->slots_.reserve(nodes);
+	this->bytes_.reserve(bytes);
+}
+
+std::size_t Dom::size(Index index) const {
+	auto const& node = this->nodes_[index];
+	switch(node.type) {
+	case Type::Map:
+	case Type::List:
+		return node.size;
+
+	default:
+		return 0;
+	}
+}
+
+bool Dom::get(Index index, StorageOf<Type::Nil> value) const {
+	return this->nodes_[index].type == Type::Nil;
+}
+
+bool Dom::get(Index index, StorageOf<Type::Bool>& value) const {
+	auto const& node = this->nodes_[index];
+	if(node.is_plain) {
+		return assign(parseBool(this->str(index)), value);
+	}
+	if(node.type != Type::Bool) {
+		return false;
+	}
+
+	value = node.value.boolean;
+	return true;
+}
+
+bool Dom::get(Index index, StorageOf<Type::Int>& value) const {
+	auto const& node = this->nodes_[index];
+	if(node.is_plain) {
+		return assign(parseInt(this->str(index)), value);
+	}
+	if(node.type != Type::Int) {
+		return false;
+	}
+
+	value = node.value.integer;
+	return true;
+}
+
+bool Dom::get(Index index, StorageOf<Type::Num>& value) const {
+	auto const& node = this->nodes_[index];
+	if(node.is_plain) {
+		return assign(parseNum(this->str(index)), value);
+	}
+	if(node.type != Type::Num) {
+		return false;
+	}
+
+	value = node.value.number;
+	return true;
+}
+
+bool Dom::get(Index index, StorageOf<Type::Str>& value) const {
+	if(this->nodes_[index].type != Type::Str) {
+		return false;
+	}
+
+	value = this->str(index);
+	return true;
+}
+
+bool Dom::get(Index index, std::span<StorageOf<Type::Int>> values) const {
+	return this->getAll_<Type::Int>(index, values);
+}
+
+bool Dom::get(Index index, std::span<StorageOf<Type::Num>> values) const {
+	return this->getAll_<Type::Num>(index, values);
+}
+
+std::string_view Dom::str(Index index) const {
+	auto const& node = this->nodes_[index];
+	if(node.type != Type::Str) {
+		return std::string_view();
+	}
+
+	if(node.is_external) {
+		return std::string_view(node.value.data, node.size);
+	}
+
+	return std::string_view(this->bytes_.data() + node.value.offset, node.size);
+}
+
+Dom::Index Dom::at(Index index, std::size_t n) const {
+	auto const& node = this->nodes_[index];
+	if((node.type != Type::Map && node.type != Type::List) || n >= node.size) {
+		return npos;
+	}
+
+	return this->slots_[node.value.offset + n].node;
+}
+
+std::string_view Dom::keyAt(Index index, std::size_t n) const {
+	auto const& node = this->nodes_[index];
+	if(node.type != Type::Map || n >= node.size) {
+		return std::string_view();
+	}
+
+	return this->slots_[node.value.offset + n].key.str();
+}
+
+Symbol Dom::symbolAt(Index index, std::size_t n) const {
+	auto const& node = this->nodes_[index];
+	if(node.type != Type::Map || n >= node.size) {
+		return Symbol();
+	}
+
+	return this->slots_[node.value.offset + n].key;
+}
+
+Dom::Index Dom::find(Index index, Symbol key) const {
+	auto const& node = this->nodes_[index];
+	if(node.type != Type::Map) {
+		return npos;
+	}
+
+	auto const i = this->position_(index, key);
+	if(i == npos) {
+		return npos;
+	}
+
+	return this->slots_[node.value.offset + i].node;
+}
+
+Dom::Index Dom::find(Index index, Symbol key, std::size_t& hint) const {
+	auto const& node = this->nodes_[index];
+	if(node.type != Type::Map) {
+		return npos;
+	}
+
+	auto const* const first = this->slots_.data() + node.value.offset;
+	if(hint < node.size && first[hint].key == key) {
+		return first[hint].node;
+	}
+
+	auto const i = this->position_(index, key);
+	if(i == npos) {
+		return npos;
+	}
+
+	hint = i;
+	return first[i].node;
+}
+
+Dom::Index Dom::find(Index index, std::string_view key) const {
+	// A key that was never interned cannot be in any Dom.
+	auto const symbol = Symbol::find(key);
+	if(!symbol.has_value()) {
+		return npos;
+	}
+
+	return this->find(index, *symbol);
+}
+
+void Dom::set(Index index, StorageOf<Type::Nil> value) {
+	this->reset(index, Type::Nil);
+}
+
+void Dom::set(Index index, StorageOf<Type::Bool> value) {
+	this->reset(index, Type::Bool);
+	this->nodes_[index].value.boolean = value;
+}
+
+void Dom::set(Index index, StorageOf<Type::Int> value) {
+	this->reset(index, Type::Int);
+	this->nodes_[index].value.integer = value;
+}
+
+void Dom::set(Index index, StorageOf<Type::Num> value) {
+	this->reset(index, Type::Num);
+	this->nodes_[index].value.number = value;
+}
+
+void Dom::set(Index index, std::string_view value) {
+	// Store first since `value` may refer to the bytes of this Dom.
+	auto const offset = this->store_(value);
+
+	this->reset(index, Type::Str);
+
+	auto& node        = this->nodes_[index];
+	node.size         = static_cast<std::uint32_t>(value.size());
+	node.value.offset = offset;
+}
+
+void Dom::setPlain(Index index, std::string_view value) {
+	this->set(index, value);
+	this->nodes_[index].is_plain = true;
+}
+
+void Dom::setView(Index index, std::string_view value) {
+	this->reset(index, Type::Str);
+
+	auto& node       = this->nodes_[index];
+	node.is_external = true;
+	node.size        = static_cast<std::uint32_t>(value.size());
+	node.value.data  = value.data();
+}
+
+void Dom::reset(Index index, Type type) {
+	auto& node = this->nodes_[index];
+	if(node.is_indexed) {
+		this->indices_.erase(index);
+	}
+
+	node.type         = type;
+	node.is_plain     = false;
+	node.is_indexed   = false;
+	node.is_external  = false;
+	node.size         = 0;
+	node.capacity     = 0;
+	node.value.offset = 0;
+}
+
+void Dom::reserve(Index index, std::size_t n) {
+	auto& node = this->nodes_[index];
+	assert(node.type == Type::Map || node.type == Type::List);
+	if(node.capacity >= n) {
+		return;
+	}
+
+	auto const offset = this->slots_.size();
+	if(node.capacity > 0 && node.value.offset + node.capacity == offset) {
+		// Child table is at the end so it can grow in place.
+		this->slots_.resize(node.value.offset + n);
+		node.capacity = static_cast<std::uint32_t>(n);
+		return;
+	}
+
+	this->slots_.resize(offset + n);
+
+	// Previous slots are left behind; they are released with the Dom.
+	auto const first = this->slots_.begin() + node.value.offset;
+	std::copy(first, first + node.size, this->slots_.begin() + offset);
+
+	node.capacity     = static_cast<std::uint32_t>(n);
+	node.value.offset = offset;
+}
+
+Dom::Index Dom::append(Index index) {
+	assert(this->nodes_[index].type == Type::List);
+
+	auto const next = this->make_();
+	this->push_(index).node = next;
+
+	return next;
+}
+
+Dom::Index Dom::child(Index index, std::size_t n) {
+	assert(this->nodes_[index].type == Type::List);
+
+	auto const size = this->nodes_[index].size;
+	if(n < size) {
+		return this->slots_[this->nodes_[index].value.offset + n].node;
+	}
+
+	this->reserve(index, n + 1);
+	for(std::size_t i = size; i < n; ++i) {
+		this->append(index);
+	}
+
+	return this->append(index);
+}
+
+Dom::Index Dom::child(Index index, Symbol key) {
+	assert(this->nodes_[index].type == Type::Map);
+
+	auto const found = this->find(index, key);
+	if(found != npos) {
+		return found;
+	}
+
+	auto const next = this->make_();
+
+	auto& slot = this->push_(index);
+	slot.node  = next;
+	slot.key   = key;
+
+	auto&      node = this->nodes_[index];
+	auto const size = node.size;
+	if(node.is_indexed) {
+		this->indices_[index].emplace(key, size - 1);
+	} else if(size == IndexThreshold) {
+		auto& keys = this->indices_[index];
+		keys.reserve(size * 2);
+
+		auto const* const first = this->slots_.data() + node.value.offset;
+		for(std::uint32_t i = 0; i < size; ++i) {
+			keys.emplace(first[i].key, i);
+		}
+
+		node.is_indexed = true;
+	}
+
+	return next;
+}
+
+void Dom::graft(Index index, Dom const& src, Index node) {
+	// Copied since `src` may be this Dom whose nodes can be relocated while grafting.
+	auto const from = src.nodes_[node];
+	switch(from.type) {
+	case Type::Str: {
+		this->set(index, src.str(node));
+		this->nodes_[index].is_plain = from.is_plain;
+		return;
+	}
+
+	case Type::Map: {
+		this->reset(index, Type::Map);
+		this->reserve(index, from.size);
+		for(std::size_t i = 0; i < from.size; ++i) {
+			auto const next = this->child(index, src.symbolAt(node, i));
+			this->graft(next, src, src.at(node, i));
+		}
+		return;
+	}
+
+	case Type::List: {
+		this->reset(index, Type::List);
+		this->reserve(index, from.size);
+		for(std::size_t i = 0; i < from.size; ++i) {
+			auto const next = this->append(index);
+			this->graft(next, src, src.at(node, i));
+		}
+		return;
+	}
+
+	default: {
+		// Drops the key index if the node was a wide map.
+		this->reset(index, from.type);
+		this->nodes_[index] = from;
+		return;
+	}
+	}
+}
+
+template<Type T>
+bool Dom::getAll_(Index index, std::span<StorageOf<T>> values) const {
+	auto const& node = this->nodes_[index];
+	if(node.type != Type::List || node.size != values.size()) {
+		return false;
+	}
+
+	auto const* const slots = this->slots_.data() + node.value.offset;
+	for(std::size_t i = 0; i < values.size(); ++i) {
+		auto const& next = this->nodes_[slots[i].node];
+		if(next.is_plain) {
+			if(!this->get(slots[i].node, values[i])) {
+				return false;
+			}
+			continue;
+		}
+		if(next.type != T) {
+			return false;
+		}
+
+		if constexpr(T == Type::Int) {
+			values[i] = next.value.integer;
+		} else {
+			values[i] = next.value.number;
+		}
+	}
+
+	return true;
+}
+
+bool Dom::isPlainAs_(Index index, Type type) const {
+	auto const text = this->str(index);
+	switch(type) {
+	case Type::Bool: return parseBool(text).has_value();
+	case Type::Int: return parseInt(text).has_value();
+	case Type::Num: return parseNum(text).has_value();
+
+	default: return false;
+	}
+}
+
+std::size_t Dom::position_(Index index, Symbol key) const {
+	auto const& node = this->nodes_[index];
+	if(node.is_indexed) {
+		auto const& keys = this->indices_.find(index)->second;
+
+		auto const it = keys.find(key);
+		return it == keys.end() ? npos : it->second;
+	}
+
+	auto const* const first = this->slots_.data() + node.value.offset;
+	for(std::size_t i = 0; i < node.size; ++i) {
+		if(first[i].key == key) {
+			return i;
+		}
+	}
+
+	return npos;
+}
+
+Dom::Index Dom::make_() {
+	auto const index = static_cast<Index>(this->nodes_.size());
+	this->nodes_.emplace_back();
+
+	return index;
+}
+
+std::size_t Dom::store_(std::string_view value) {
+	auto const* const data = this->bytes_.data();
+	auto const        size = this->bytes_.size();
+
+	// `value` may refer to the bytes of this Dom which can be relocated by the resize.
+	bool const is_own = std::less_equal<char const*>()(data, value.data()) && std::less<char const*>()(value.data(), data + size);
+	auto const origin = is_own ? static_cast<std::size_t>(value.data() - data) : 0;
+
+	this->bytes_.resize(size + value.size());
+	std::memcpy(this->bytes_.data() + size, is_own ? this->bytes_.data() + origin : value.data(), value.size());
+
+	return size;
+}
+
+Dom::Slot& Dom::push_(Index index) {
+	auto const& node = this->nodes_[index];
+	if(node.size == node.capacity) {
+		this->reserve(index, std::max<std::size_t>(4, std::size_t(node.capacity) * 2));
+	}
+
+	auto& curr = this->nodes_[index];
+	auto& slot = this->slots_[curr.value.offset + curr.size];
+	++curr.size;
+
+	slot = Slot{};
+	return slot;
+}
+
+}  // namespace cray
@@ -1,32 +1,361 @@
 #include "cray/load.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <latch>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
+
+#include "cray/detail/function_ref.hpp"
+#include "cray/dom.hpp"
+#include "cray/source.hpp"
+#include "cray/symbol.hpp"
+#include "cray/types.hpp"
+#include "cray/writer.hpp"
 
 namespace cray {
 
 namespace {
 
-LoaderRegistry global_registry;
+// Loaders of other translation units register themselves while static objects are initialized.
+LoaderRegistry& globalRegistry() {
+	static LoaderRegistry registry;
+	return registry;
+}
+
+struct Pool {
+	// Factory that made the loaders; the key of a pool may be reused by another one.
+	std::weak_ptr<LoaderFactory> factory;
+
+	std::vector<std::shared_ptr<Loader>> idle;
+};
+
+// Set while `pools` of the thread is alive, so loaders released during thread exit are dropped.
+thread_local bool are_pools_alive = false;
+
+struct Pools {
+	Pools() {
+		are_pools_alive = true;
+	}
+
+	~Pools() {
+		are_pools_alive = false;
+	}
+
+	std::unordered_map<LoaderFactory const*, Pool> value;
+};
+
+thread_local Pools pools;
+
+/**
+ * @brief Read-only stream buffer over bytes owned by someone else.
+ */
+class ViewBuf: public std::streambuf {
+   public:
+	ViewBuf(std::string_view data) {
+		auto* const begin = const_cast<char*>(data.data());
+		this->setg(begin, begin, begin + data.size());
+	}
+
+   protected:
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+		if(!(which & std::ios_base::in)) {
+			return pos_type(off_type(-1));
+		}
+
+		char* base = nullptr;
+		switch(dir) {
+		case std::ios_base::beg: base = this->eback(); break;
+		case std::ios_base::cur: base = this->gptr(); break;
+		case std::ios_base::end: base = this->egptr(); break;
+		default: return pos_type(off_type(-1));
+		}
+
+		auto const pos = base - this->eback() + off;
+		if(pos < 0 || pos > this->egptr() - this->eback()) {
+			return pos_type(off_type(-1));
+		}
+
+		this->setg(this->eback(), this->eback() + pos, this->egptr());
+		return pos_type(pos);
+	}
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+		return this->seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+};
+
+/**
+ * @brief Threads that run submitted tasks until the pool is destroyed. Tasks left in the queue
+ * are run before the threads exit.
+ */
+class WorkerPool {
+   public:
+	WorkerPool(std::size_t size) {
+		for(std::size_t i = 0; i < size; ++i) {
+			this->threads_.emplace_back([this] { this->work_(); });
+		}
+	}
+
+	~WorkerPool() {
+		{
+			std::scoped_lock lock(this->mutex_);
+			this->is_stopped_ = true;
+		}
+
+		this->cv_.notify_all();
+		for(auto& thread: this->threads_) {
+			thread.join();
+		}
+	}
+
+	void submit(std::function<void()> task) {
+		{
+			std::scoped_lock lock(this->mutex_);
+			this->tasks_.push_back(std::move(task));
+		}
+
+		this->cv_.notify_one();
+	}
+
+   private:
+	void work_() {
+		while(true) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock(this->mutex_);
+				this->cv_.wait(lock, [this] { return this->is_stopped_ || !this->tasks_.empty(); });
+				if(this->tasks_.empty()) {
+					return;
+				}
+
+				task = std::move(this->tasks_.front());
+				this->tasks_.pop_front();
+			}
+
+			task();
+		}
+	}
+
+	std::mutex                        mutex_;
+	std::condition_variable           cv_;
+	std::deque<std::function<void()>> tasks_;
+	bool                              is_stopped_ = false;
+
+	std::vector<std::thread> threads_;
+};
+
+class SingleDocumentReader: public DocumentReader {
+   public:
+	SingleDocumentReader(std::shared_ptr<Source> document)
+	    : document_(std::move(document)) { }
+
+	std::shared_ptr<Source> next() override {
+		return std::exchange(this->document_, nullptr);
+	}
+
+   private:
+	std::shared_ptr<Source> document_;
+};
+
+/**
+ * @brief Writer that builds each element of the list at the top into the same Dom and passes it
+ * on as soon as the element ends.
+ */
+class ElementWriter: public Writer {
+   public:
+	// Thrown to stop the loader once the functor returns `false`.
+	struct Stop { };
+
+	ElementWriter(detail::FunctionRef<bool(Source::Cursor const& element)> functor)
+	    : functor_(functor) { }
+
+	void beginMap() override {
+		this->begin_(Type::Map);
+	}
+
+	void endMap() override {
+		this->end_();
+	}
+
+	void beginList() override {
+		this->begin_(Type::List);
+	}
+
+	void endList() override {
+		this->end_();
+	}
+
+	void key(std::string_view key) override {
+		this->frames_.back().key = Symbol(key);
+	}
+
+	void value(StorageOf<Type::Nil> value) override {
+		if(!this->is_in_list_) {
+			// A `nil` document has no elements.
+			return;
+		}
+
+		this->set_(value);
+	}
+
+	// clang-format off
+	void value(StorageOf<Type::Bool> value) override { this->set_(value); }
+	void value(StorageOf<Type::Int>  value) override { this->set_(value); }
+	void value(StorageOf<Type::Num>  value) override { this->set_(value); }
+	void value(std::string_view      value) override { this->set_(value); }
+	// clang-format on
+
+	void scalar(Source::Cursor const& src) override {
+		// A string that reads as other types too is kept as such.
+		bool const is_plain = src.is(Type::Str) && (src.is(Type::Bool) || src.is(Type::Int) || src.is(Type::Num));
+		if(!is_plain) {
+			return Writer::scalar(src);
+		}
+
+		StorageOf<Type::Str> value;
+		src.get(value);
+		this->dom_->setPlain(this->place_(), value);
+		this->done_();
+	}
+
+   private:
+	struct Frame {
+		Dom::Index index;
+
+		// Key of the next child of a map.
+		Symbol key;
+	};
+
+	template<typename V>
+	void set_(V value) {
+		this->dom_->set(this->place_(), value);
+		this->done_();
+	}
+
+	void begin_(Type type) {
+		if(!this->is_in_list_ && type == Type::List) {
+			this->is_in_list_ = true;
+			return;
+		}
+
+		auto const index = this->place_();
+		this->dom_->reset(index, type);
+		this->frames_.push_back(Frame{.index = index, .key = Symbol()});
+	}
+
+	void end_() {
+		if(this->frames_.empty()) {
+			// End of the list at the top.
+			return;
+		}
+
+		this->frames_.pop_back();
+		this->done_();
+	}
+
+	/**
+	 * @return Index of a new node in the innermost container, or of the root for a new element.
+	 */
+	Dom::Index place_() {
+		if(!this->is_in_list_) {
+			throw std::invalid_argument("document is not a list");
+		}
+
+		if(this->frames_.empty()) {
+			this->dom_->clear();
+			return this->dom_->root();
+		}
+
+		auto const& frame = this->frames_.back();
+		if(this->dom_->is(frame.index, Type::List)) {
+			return this->dom_->append(frame.index);
+		}
+
+		return this->dom_->child(frame.index, frame.key);
+	}
+
+	/**
+	 * @brief Passes on the element once its top value is done.
+	 */
+	void done_() {
+		if(!this->frames_.empty()) {
+			return;
+		}
+		if(!this->functor_(Source::Cursor(*this->src_))) {
+			throw Stop();
+		}
+	}
+
+	detail::FunctionRef<bool(Source::Cursor const& element)> functor_;
+
+	std::shared_ptr<Dom>    dom_ = std::make_shared<Dom>();
+	std::shared_ptr<Source> src_ = Source::fromDom(this->dom_);
+
+	std::vector<Frame> frames_;
+
+	// Whether the list at the top is open.
+	bool is_in_list_ = false;
+};
+
+}  // namespace
+
+std::shared_ptr<Source> Loader::load(std::string_view data) {
+	ViewBuf      buf(data);
+	std::istream in(&buf);
+	return this->load(in);
+}
+
+std::unique_ptr<DocumentReader> Loader::documents(std::istream& in) {
+	return std::make_unique<SingleDocumentReader>(this->load(in));
+}
 
+void Loader::emit(std::istream& in, Writer& dst) {
+	auto const src = this->load(in);
+	dst.write(Source::Cursor(*src));
+}
+
+void Loader::elements(std::istream& in, detail::FunctionRef<bool(Source::Cursor const& element)> functor) {
+	ElementWriter writer(functor);
+	try {
+		this->emit(in, writer);
+	} catch(ElementWriter::Stop const&) {
+	}
 }
 
 bool LoaderRegistry::has(std::string const& name) const {
+	std::shared_lock lock(this->mutex_);
 	return this->factories_.contains(name);
 }
 
 void LoaderRegistry::add(std::shared_ptr<LoaderFactory> factory) {
 	auto name = factory->name();
-	this->factories_.insert_or_assign(std::move(name), std::move(factory));
+	this->add(std::move(name), std::move(factory));
 }
 
 void LoaderRegistry::add(std::string name, std::shared_ptr<LoaderFactory> factory) {
+	std::unique_lock lock(this->mutex_);
 	this->factories_.insert_or_assign(std::move(name), std::move(factory));
 }
 
 std::shared_ptr<LoaderFactory> LoaderRegistry::get(std::string const& name) const {
+	std::shared_lock lock(this->mutex_);
+
 	auto it = this->factories_.find(name);
 	if(it == this->factories_.cend()) {
 		return nullptr;
@@ -35,24 +364,148 @@ std::shared_ptr<LoaderFactory> LoaderRegistry::get(std::string const& name) cons
 	}
 }
 
+std::shared_ptr<Loader> LoaderRegistry::acquire(std::string const& name) const {
+	auto factory = this->get(name);
+	if(factory == nullptr) {
+		return nullptr;
+	}
+
+	auto& pool = pools.value[factory.get()];
+	if(pool.factory.lock() != factory) {
+		pool = Pool{.factory = factory, .idle = {}};
+	}
+
+	std::shared_ptr<Loader> loader;
+	if(pool.idle.empty()) {
+		loader = factory->make();
+	} else {
+		loader = std::move(pool.idle.back());
+		pool.idle.pop_back();
+	}
+
+	auto* const ptr = loader.get();
+	return std::shared_ptr<Loader>(ptr, [loader = std::move(loader), owner = std::weak_ptr(factory), thread = std::this_thread::get_id()](Loader*) mutable {
+		if(!are_pools_alive || std::this_thread::get_id() != thread) {
+			return;
+		}
+
+		auto const factory = owner.lock();
+		if(factory == nullptr) {
+			return;
+		}
+
+		// The pool is gone if the factory was replaced by another at the same address.
+		auto const it = pools.value.find(factory.get());
+		if(it == pools.value.end() || it->second.factory.lock() != factory) {
+			return;
+		}
+
+		it->second.idle.push_back(std::move(loader));
+	});
+}
+
 namespace loader_registry {
 
 bool has(std::string const& name) {
-	return global_registry.has(name);
+	return globalRegistry().has(name);
 }
 
 void add(std::shared_ptr<LoaderFactory> factory) {
-	global_registry.add(std::move(factory));
+	globalRegistry().add(std::move(factory));
 }
 
 void add(std::string name, std::shared_ptr<LoaderFactory> factory) {
-	global_registry.add(std::move(name), std::move(factory));
+	globalRegistry().add(std::move(name), std::move(factory));
 }
 
 std::shared_ptr<LoaderFactory> get(std::string const& name) {
-	return global_registry.get(name);
+	return globalRegistry().get(name);
+}
+
+std::shared_ptr<Loader> acquire(std::string const& name) {
+	return globalRegistry().acquire(name);
 }
 
 }  // namespace loader_registry
 
+namespace load {
+
+Documents documents(std::string const& name, std::istream& in) {
+	auto const loader = loader_registry::acquire(name);
+	if(loader == nullptr) {
+		return Documents();
+	}
+
+	return Documents(loader->documents(in));
+}
+
+void elements(std::string const& name, std::istream& in, detail::FunctionRef<bool(Source::Cursor const& element)> functor) {
+	auto const loader = loader_registry::acquire(name);
+	if(loader == nullptr) {
+		throw std::invalid_argument("no loader named " + name);
+	}
+
+	loader->elements(in, functor);
+}
+
+void jsonLines(std::istream& in, std::size_t batch_size, detail::FunctionRef<void(std::size_t slot, Source::Cursor const& record)> visit, detail::FunctionRef<bool(std::size_t slot)> take) {
+	std::size_t const size = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+	WorkerPool pool(size);
+	return jsonLines(in, batch_size, visit, take, [&pool](std::function<void()> task) { pool.submit(std::move(task)); });
+}
+
+std::shared_ptr<Source> fromFiles(std::string const& name, std::vector<std::filesystem::path> const& paths) {
+	std::size_t const size = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, std::max<std::size_t>(paths.size(), 1));
+
+	WorkerPool pool(size);
+	return fromFiles(name, paths, [&pool](std::function<void()> task) { pool.submit(std::move(task)); });
+}
+
+std::shared_ptr<Source> fromFiles(std::string const& name, std::vector<std::filesystem::path> const& paths, Executor const& executor) {
+	if(paths.empty()) {
+		throw std::invalid_argument("no files to load");
+	}
+	if(!loader_registry::has(name)) {
+		return nullptr;
+	}
+
+	std::vector<std::shared_ptr<Source>> layers(paths.size());
+	std::vector<std::exception_ptr>      errors(paths.size());
+
+	std::latch done(static_cast<std::ptrdiff_t>(paths.size()));
+	for(std::size_t i = 0; i < paths.size(); ++i) {
+		try {
+			executor([&, i] {
+				try {
+					layers[i] = Source::load(name, paths[i]);
+				} catch(...) {
+					errors[i] = std::current_exception();
+				}
+				done.count_down();
+			});
+		} catch(...) {
+			// Tasks already submitted refer to this frame.
+			done.count_down(static_cast<std::ptrdiff_t>(paths.size() - i));
+			done.wait();
+			throw;
+		}
+	}
+	done.wait();
+
+	for(auto const& error: errors) {
+		if(error) {
+			std::rethrow_exception(error);
+		}
+	}
+	if(std::ranges::find(layers, nullptr) != layers.end()) {
+		// The loader was removed in the meantime.
+		return nullptr;
+	}
+
+	return Source::overlay(std::move(layers));
+}
+
+}  // namespace load
+
 }  // namespace cray
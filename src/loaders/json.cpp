@@ -0,0 +1,1438 @@
+#include "cray/load.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cray/detail/function_ref.hpp"
+#include "cray/detail/mapped_file.hpp"
+#include "cray/dom.hpp"
+#include "cray/source.hpp"
+#include "cray/symbol.hpp"
+#include "cray/types.hpp"
+#include "cray/writer.hpp"
+
+namespace cray {
+namespace {
+
+/**
+ * @brief Position of the first byte of \a data that ends the plain run of a string, i.e. a quote,
+ * a backslash, or a control character. `data.size()` if there is none.
+ *
+ * Reads 8 bytes at a time, testing all of them with a few integer operations.
+ */
+std::size_t findStringEnd(std::string_view data) {
+	constexpr std::uint64_t Ones = 0x0101010101010101;
+	constexpr std::uint64_t High = 0x8080808080808080;
+
+	// High bit of each byte that is zero; bytes above the first one may be set spuriously.
+	constexpr auto zeros = [](std::uint64_t word) { return (word - Ones) & ~word & High; };
+
+	std::size_t i = 0;
+	if constexpr(std::endian::native == std::endian::little) {
+		for(; i + 8 <= data.size(); i += 8) {
+			std::uint64_t word;
+			std::memcpy(&word, data.data() + i, 8);
+
+			auto const found = zeros(word ^ (Ones * '"')) | zeros(word ^ (Ones * '\\')) | ((word - Ones * 0x20) & ~word & High);
+			if(found != 0) {
+				return i + std::countr_zero(found) / 8;
+			}
+		}
+	}
+
+	for(; i < data.size(); ++i) {
+		auto const c = static_cast<unsigned char>(data[i]);
+		if(c == '"' || c == '\\' || c < 0x20) {
+			return i;
+		}
+	}
+
+	return data.size();
+}
+
+inline bool isSpace(char c) {
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool isBlank(std::string_view text) {
+	return std::ranges::all_of(text, isSpace);
+}
+
+void appendUtf8(std::string& dst, char32_t code) {
+	if(code < 0x80) {
+		dst += static_cast<char>(code);
+	} else if(code < 0x800) {
+		dst += static_cast<char>(0xC0 | (code >> 6));
+		dst += static_cast<char>(0x80 | (code & 0x3F));
+	} else if(code < 0x10000) {
+		dst += static_cast<char>(0xE0 | (code >> 12));
+		dst += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		dst += static_cast<char>(0x80 | (code & 0x3F));
+	} else {
+		dst += static_cast<char>(0xF0 | (code >> 18));
+		dst += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+		dst += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		dst += static_cast<char>(0x80 | (code & 0x3F));
+	}
+}
+
+/**
+ * @brief Symbols of keys seen by a loader, so repeated keys are not looked up in the process-wide
+ * table, which is shared by every thread.
+ */
+class SymbolCache {
+   public:
+	Symbol get(std::string_view key) {
+		auto const it = this->symbols_.find(key);
+		if(it != this->symbols_.end()) {
+			return it->second;
+		}
+
+		// Keys of an unbounded document must not grow the cache forever.
+		if(this->symbols_.size() >= MaxSize) {
+			this->symbols_.clear();
+		}
+
+		Symbol const symbol(key);
+		this->symbols_.emplace(symbol.str(), symbol);
+		return symbol;
+	}
+
+   private:
+	static constexpr std::size_t MaxSize = 1 << 16;
+
+	// Keys refer to the string of the interned Symbol.
+	std::unordered_map<std::string_view, Symbol> symbols_;
+};
+
+/**
+ * @brief Recursive descent parser of RFC 8259 JSON that writes into a Dom as it reads.
+ */
+class JsonParser {
+   public:
+	/**
+	 * @param pos Offset in \a data to start reading at; errors report offsets in \a data.
+	 */
+	JsonParser(std::string_view data, std::string& scratch, SymbolCache& symbols, std::size_t pos = 0)
+	    : data_(data)
+	    , pos_(pos)
+	    , scratch_(scratch)
+	    , symbols_(symbols) { }
+
+	/**
+	 * @brief Makes strings without escapes refer to the data instead of being copied into the
+	 * Dom. The data must outlive the Dom.
+	 */
+	JsonParser& refer() {
+		this->is_referring_ = true;
+		return *this;
+	}
+
+	/**
+	 * @brief Parses the value that spans to the end of the data into the root of \a dom.
+	 */
+	void parse(Dom& dom) {
+		this->parse(dom, dom.root());
+	}
+
+	/**
+	 * @brief Parses the value that spans to the end of the data into the node \a index of \a dom.
+	 */
+	void parse(Dom& dom, Dom::Index index) {
+		this->dom_ = &dom;
+
+		this->skipSpaces_();
+		if(this->pos_ == this->data_.size()) {
+			// Same as an empty YAML document.
+			return;
+		}
+
+		this->parseValue_(index, 0);
+
+		this->skipSpaces_();
+		if(this->pos_ != this->data_.size()) {
+			this->fail_("unexpected character after the document");
+		}
+	}
+
+	/**
+	 * @brief Parses the value that spans to the end of the data into events of \a dst. Values of
+	 * keys that \a dst does not want are skipped over without being parsed.
+	 */
+	void emit(Writer& dst) {
+		this->skipSpaces_();
+		if(this->pos_ == this->data_.size()) {
+			return dst.value(nullptr);
+		}
+
+		this->emitValue_(dst, 0);
+
+		this->skipSpaces_();
+		if(this->pos_ != this->data_.size()) {
+			this->fail_("unexpected character after the document");
+		}
+	}
+
+	/**
+	 * @brief Reads the map or list that spans to the end of the data without parsing its children.
+	 * \a functor is called with the key, empty for a list, and the range of each child.
+	 *
+	 * Children are only checked to be balanced, so errors in them are found once they are parsed.
+	 */
+	void scan(detail::FunctionRef<void(std::string_view key, std::size_t begin, std::size_t end)> functor) {
+		this->skipSpaces_();
+
+		auto const open  = this->peek_();
+		auto const close = open == '{' ? '}' : ']';
+		++this->pos_;
+
+		this->skipSpaces_();
+		if(this->peek_() == close) {
+			++this->pos_;
+		} else {
+			while(true) {
+				this->skipSpaces_();
+
+				std::string_view key;
+				if(open == '{') {
+					if(this->peek_() != '"') {
+						this->fail_("expected a key");
+					}
+
+					key = this->parseString_();
+
+					this->skipSpaces_();
+					this->expect_(':');
+					this->skipSpaces_();
+				}
+
+				auto const begin = this->pos_;
+				this->skipValue_();
+				functor(key, begin, this->pos_);
+
+				this->skipSpaces_();
+				if(this->peek_() == ',') {
+					++this->pos_;
+					continue;
+				}
+
+				this->expect_(close);
+				break;
+			}
+		}
+
+		this->skipSpaces_();
+		if(this->pos_ != this->data_.size()) {
+			this->fail_("unexpected character after the document");
+		}
+	}
+
+   private:
+	static constexpr std::size_t MaxDepth = 512;
+
+	[[noreturn]] void fail_(char const* what) const {
+		throw std::invalid_argument("invalid JSON: " + std::string(what) + " at offset " + std::to_string(this->pos_));
+	}
+
+	inline bool isEnd_() const {
+		return this->pos_ == this->data_.size();
+	}
+
+	inline char peek_() const {
+		return this->isEnd_() ? '\0' : this->data_[this->pos_];
+	}
+
+	void skipSpaces_() {
+		for(; !this->isEnd_(); ++this->pos_) {
+			if(!isSpace(this->data_[this->pos_])) {
+				return;
+			}
+		}
+	}
+
+	void expect_(char c) {
+		if(this->peek_() != c) {
+			this->fail_("unexpected character");
+		}
+
+		++this->pos_;
+	}
+
+	void expectWord_(std::string_view word) {
+		if(this->data_.substr(this->pos_, word.size()) != word) {
+			this->fail_("unexpected word");
+		}
+
+		this->pos_ += word.size();
+	}
+
+	/**
+	 * @brief Moves past the value at the cursor, tracking only brackets and strings.
+	 */
+	void skipValue_() {
+		auto const first = this->pos_;
+
+		std::size_t depth = 0;
+		do {
+			if(this->isEnd_()) {
+				this->fail_("unexpected end of the document");
+			}
+
+			switch(this->data_[this->pos_]) {
+			case '{':
+			case '[': {
+				++depth;
+				++this->pos_;
+				break;
+			}
+
+			case '}':
+			case ']': {
+				if(depth == 0) {
+					this->fail_("unexpected character");
+				}
+
+				--depth;
+				++this->pos_;
+				break;
+			}
+
+			case '"': {
+				++this->pos_;
+				while(true) {
+					this->pos_ += findStringEnd(this->data_.substr(this->pos_));
+					if(this->isEnd_()) {
+						this->fail_("unterminated string");
+					}
+
+					auto const c = this->data_[this->pos_];
+					++this->pos_;
+					if(c == '"') {
+						break;
+					}
+					if(c == '\\') {
+						++this->pos_;
+					}
+				}
+				break;
+			}
+
+			default: {
+				// A scalar or what separates values.
+				for(; !this->isEnd_(); ++this->pos_) {
+					auto const c = this->data_[this->pos_];
+					if(c == '{' || c == '[' || c == '}' || c == ']' || c == '"' || (depth == 0 && c == ',')) {
+						break;
+					}
+				}
+				if(depth == 0) {
+					// Drop trailing spaces from the range.
+					while(this->pos_ > first && isSpace(this->data_[this->pos_ - 1])) {
+						--this->pos_;
+					}
+					return;
+				}
+				break;
+			}
+			}
+		} while(depth > 0);
+	}
+
+	void parseValue_(Dom::Index index, std::size_t depth) {
+		if(depth > MaxDepth) {
+			this->fail_("too deeply nested");
+		}
+
+		switch(this->peek_()) {
+		case '{': return this->parseMap_(index, depth);
+		case '[': return this->parseList_(index, depth);
+		case '"': {
+			auto const value = this->parseString_();
+			if(this->is_referring_ && value.data() != this->scratch_.data()) {
+				return this->dom_->setView(index, value);
+			}
+
+			return this->dom_->set(index, value);
+		}
+
+		case 'n': {
+			this->expectWord_("null");
+			return this->dom_->set(index, nullptr);
+		}
+		case 't': {
+			this->expectWord_("true");
+			return this->dom_->set(index, true);
+		}
+		case 'f': {
+			this->expectWord_("false");
+			return this->dom_->set(index, false);
+		}
+
+		default: return this->parseNumber_([&](auto value) { this->dom_->set(index, value); });
+		}
+	}
+
+	void emitValue_(Writer& dst, std::size_t depth) {
+		if(depth > MaxDepth) {
+			this->fail_("too deeply nested");
+		}
+
+		switch(this->peek_()) {
+		case '{': return this->emitMap_(dst, depth);
+		case '[': return this->emitList_(dst, depth);
+		case '"': return dst.value(this->parseString_());
+
+		case 'n': {
+			this->expectWord_("null");
+			return dst.value(nullptr);
+		}
+		case 't': {
+			this->expectWord_("true");
+			return dst.value(true);
+		}
+		case 'f': {
+			this->expectWord_("false");
+			return dst.value(false);
+		}
+
+		default: return this->parseNumber_([&](auto value) { dst.value(value); });
+		}
+	}
+
+	void emitMap_(Writer& dst, std::size_t depth) {
+		++this->pos_;
+		dst.beginMap();
+
+		this->skipSpaces_();
+		if(this->peek_() == '}') {
+			++this->pos_;
+			return dst.endMap();
+		}
+
+		while(true) {
+			this->skipSpaces_();
+			if(this->peek_() != '"') {
+				this->fail_("expected a key");
+			}
+
+			auto const key     = this->parseString_();
+			bool const is_kept = dst.wants(key);
+			if(is_kept) {
+				dst.key(key);
+			}
+
+			this->skipSpaces_();
+			this->expect_(':');
+			this->skipSpaces_();
+			if(is_kept) {
+				this->emitValue_(dst, depth + 1);
+			} else {
+				this->skipValue_();
+			}
+
+			this->skipSpaces_();
+			if(this->peek_() == ',') {
+				++this->pos_;
+				continue;
+			}
+
+			this->expect_('}');
+			return dst.endMap();
+		}
+	}
+
+	void emitList_(Writer& dst, std::size_t depth) {
+		++this->pos_;
+		dst.beginList();
+
+		this->skipSpaces_();
+		if(this->peek_() == ']') {
+			++this->pos_;
+			return dst.endList();
+		}
+
+		while(true) {
+			this->skipSpaces_();
+			this->emitValue_(dst, depth + 1);
+
+			this->skipSpaces_();
+			if(this->peek_() == ',') {
+				++this->pos_;
+				continue;
+			}
+
+			this->expect_(']');
+			return dst.endList();
+		}
+	}
+
+	void parseMap_(Dom::Index index, std::size_t depth) {
+		++this->pos_;
+		this->dom_->reset(index, Type::Map);
+
+		this->skipSpaces_();
+		if(this->peek_() == '}') {
+			++this->pos_;
+			return;
+		}
+
+		while(true) {
+			this->skipSpaces_();
+			if(this->peek_() != '"') {
+				this->fail_("expected a key");
+			}
+
+			// A duplicated key keeps its first position and takes the last value. The Dom indexes
+			// the keys of a wide map, so an object of any width is read in linear time.
+			auto const key  = this->symbols_.get(this->parseString_());
+			auto const next = this->dom_->child(index, key);
+
+			this->skipSpaces_();
+			this->expect_(':');
+			this->skipSpaces_();
+			this->parseValue_(next, depth + 1);
+
+			this->skipSpaces_();
+			if(this->peek_() == ',') {
+				++this->pos_;
+				continue;
+			}
+
+			this->expect_('}');
+			return;
+		}
+	}
+
+	void parseList_(Dom::Index index, std::size_t depth) {
+		++this->pos_;
+		this->dom_->reset(index, Type::List);
+
+		this->skipSpaces_();
+		if(this->peek_() == ']') {
+			++this->pos_;
+			return;
+		}
+
+		while(true) {
+			this->skipSpaces_();
+
+			auto const next = this->dom_->append(index);
+			this->parseValue_(next, depth + 1);
+
+			this->skipSpaces_();
+			if(this->peek_() == ',') {
+				++this->pos_;
+				continue;
+			}
+
+			this->expect_(']');
+			return;
+		}
+	}
+
+	/**
+	 * @return The string without quotes. Refers to the input if it has no escapes, otherwise to the
+	 * scratch buffer, which is valid until the next string is parsed.
+	 */
+	std::string_view parseString_() {
+		++this->pos_;
+
+		auto const first = this->pos_;
+		auto const run   = findStringEnd(this->data_.substr(first));
+		this->pos_ += run;
+		if(this->peek_() == '"') {
+			++this->pos_;
+			return this->data_.substr(first, run);
+		}
+
+		this->scratch_.assign(this->data_.substr(first, run));
+		while(true) {
+			if(this->isEnd_()) {
+				this->fail_("unterminated string");
+			}
+
+			auto const c = this->data_[this->pos_];
+			if(c == '"') {
+				++this->pos_;
+				return this->scratch_;
+			}
+			if(c != '\\') {
+				this->fail_("control character in string");
+			}
+
+			++this->pos_;
+			this->parseEscape_();
+
+			auto const next = findStringEnd(this->data_.substr(this->pos_));
+			this->scratch_.append(this->data_.substr(this->pos_, next));
+			this->pos_ += next;
+		}
+	}
+
+	void parseEscape_() {
+		auto const c = this->peek_();
+		++this->pos_;
+
+		switch(c) {
+		case '"': this->scratch_ += '"'; return;
+		case '\\': this->scratch_ += '\\'; return;
+		case '/': this->scratch_ += '/'; return;
+		case 'b': this->scratch_ += '\b'; return;
+		case 'f': this->scratch_ += '\f'; return;
+		case 'n': this->scratch_ += '\n'; return;
+		case 'r': this->scratch_ += '\r'; return;
+		case 't': this->scratch_ += '\t'; return;
+
+		case 'u': {
+			char32_t code = this->parseHex4_();
+			if(0xD800 <= code && code < 0xDC00) {
+				this->expectWord_("\\u");
+
+				auto const low = this->parseHex4_();
+				if(low < 0xDC00 || 0xE000 <= low) {
+					this->fail_("invalid surrogate pair");
+				}
+
+				code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+			} else if(0xDC00 <= code && code < 0xE000) {
+				this->fail_("invalid surrogate pair");
+			}
+
+			appendUtf8(this->scratch_, code);
+			return;
+		}
+
+		default: {
+			--this->pos_;
+			this->fail_("invalid escape");
+		}
+		}
+	}
+
+	char32_t parseHex4_() {
+		auto const digits = this->data_.substr(this->pos_, 4);
+
+		std::uint16_t code   = 0;
+		auto const [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), code, 16);
+		if(digits.size() != 4 || ec != std::errc() || ptr != digits.data() + 4) {
+			this->fail_("invalid unicode escape");
+		}
+
+		this->pos_ += 4;
+		return code;
+	}
+
+	/**
+	 * @brief Reads a number and passes it to \a sink as an Int if it is an integer that fits,
+	 * otherwise as a Num.
+	 */
+	template<typename F>
+	void parseNumber_(F&& sink) {
+		auto const first = this->pos_;
+
+		auto const is_digit = [this] {
+			auto const c = this->peek_();
+			return '0' <= c && c <= '9';
+		};
+		auto const skipDigits = [&] {
+			if(!is_digit()) {
+				this->fail_("expected a digit");
+			}
+			while(is_digit()) {
+				++this->pos_;
+			}
+		};
+
+		if(this->peek_() == '-') {
+			++this->pos_;
+		}
+		if(this->peek_() == '0') {
+			++this->pos_;
+		} else {
+			skipDigits();
+		}
+
+		bool is_integer = true;
+		if(this->peek_() == '.') {
+			++this->pos_;
+			skipDigits();
+			is_integer = false;
+		}
+		if(this->peek_() == 'e' || this->peek_() == 'E') {
+			++this->pos_;
+			if(this->peek_() == '+' || this->peek_() == '-') {
+				++this->pos_;
+			}
+			skipDigits();
+			is_integer = false;
+		}
+
+		auto const* const begin = this->data_.data() + first;
+		auto const* const end   = this->data_.data() + this->pos_;
+
+		if(is_integer) {
+			StorageOf<Type::Int> value;
+
+			auto const [ptr, ec] = std::from_chars(begin, end, value);
+			if(ec == std::errc()) {
+				return sink(value);
+			}
+
+			// Integers too large for Int are read as Num like most JSON readers do.
+		}
+
+		StorageOf<Type::Num> value;
+
+		auto const [ptr, ec] = std::from_chars(begin, end, value);
+		if(ec != std::errc()) {
+			this->fail_("number out of range");
+		}
+
+		sink(value);
+	}
+
+	std::string_view data_;
+	std::size_t      pos_;
+
+	Dom*         dom_ = nullptr;
+	std::string& scratch_;
+	SymbolCache& symbols_;
+
+	bool is_referring_ = false;
+};
+
+class JsonLoader: public Loader {
+   public:
+	using Loader::load;
+
+	std::shared_ptr<Source> load(std::istream& in) override {
+		this->read_(in);
+		return this->load(std::string_view(this->text_));
+	}
+
+	std::shared_ptr<Source> load(std::string_view data) override {
+		auto dom = std::make_shared<Dom>();
+
+		JsonParser(data, this->scratch_, this->symbols_).parse(*dom);
+		return Source::fromDom(std::move(dom));
+	}
+
+	void emit(std::istream& in, Writer& dst) override {
+		this->read_(in);
+		JsonParser(this->text_, this->scratch_, this->symbols_).emit(dst);
+	}
+
+	/**
+	 * @brief Reads \a in a chunk at a time and parses each element once its end is read. Text of
+	 * parsed elements is dropped a chunk at a time.
+	 */
+	void elements(std::istream& in, detail::FunctionRef<bool(Source::Cursor const& element)> functor) override {
+		this->text_.clear();
+
+		auto const dom = std::make_shared<Dom>();
+		auto const src = Source::fromDom(dom);
+
+		std::size_t pos = 0;
+		if(!this->skipSpaces_(in, pos)) {
+			// Same as an empty YAML document.
+			return;
+		}
+		if(this->text_[pos] != '[') {
+			// Either `null` or not a list; both are known only once the whole value is read.
+			this->readRest_(in);
+			JsonParser(this->text_, this->scratch_, this->symbols_, pos).parse(*dom);
+			if(!dom->is(dom->root(), Type::Nil)) {
+				throw std::invalid_argument("document is not a list");
+			}
+
+			return;
+		}
+
+		++pos;
+		if(!this->skipSpaces_(in, pos)) {
+			throw std::invalid_argument("invalid JSON: unexpected end of the document");
+		}
+		if(this->text_[pos] == ']') {
+			return this->finish_(in, pos + 1);
+		}
+
+		while(true) {
+			auto const end = this->findElementEnd_(in, pos);
+
+			auto const element = std::string_view(this->text_).substr(pos, end - pos);
+			if(element.find_first_not_of(" \n\r\t") == std::string_view::npos) {
+				throw std::invalid_argument("invalid JSON: expected a value at offset " + std::to_string(end));
+			}
+
+			dom->clear();
+			JsonParser(element, this->scratch_, this->symbols_).parse(*dom);
+			if(!functor(Source::Cursor(*src))) {
+				return;
+			}
+
+			pos = end + 1;
+			if(this->text_[end] == ']') {
+				return this->finish_(in, pos);
+			}
+
+			// Dropped a chunk at a time rather than per element, which would move the rest each time.
+			if(pos >= ChunkSize) {
+				this->text_.erase(0, pos);
+				pos = 0;
+			}
+		}
+	}
+
+   private:
+	static constexpr std::size_t ChunkSize = 64 * 1024;
+
+	void read_(std::istream& in) {
+		this->text_.clear();
+		this->readRest_(in);
+	}
+
+	void readRest_(std::istream& in) {
+		while(this->readChunk_(in) == ChunkSize) {
+		}
+	}
+
+	/**
+	 * @brief Appends the next chunk of \a in to the text.
+	 *
+	 * @return Number of bytes read; less than a chunk at the end of \a in.
+	 */
+	std::size_t readChunk_(std::istream& in) {
+		auto const size = this->text_.size();
+		this->text_.resize(size + ChunkSize);
+
+		auto const n = static_cast<std::size_t>(in.rdbuf()->sgetn(this->text_.data() + size, ChunkSize));
+		this->text_.resize(size + n);
+		return n;
+	}
+
+	/**
+	 * @brief Moves \a pos past spaces, reading more of \a in as needed.
+	 *
+	 * @return `false` if \a in ends before anything else.
+	 */
+	bool skipSpaces_(std::istream& in, std::size_t& pos) {
+		while(true) {
+			for(; pos < this->text_.size(); ++pos) {
+				if(!isSpace(this->text_[pos])) {
+					return true;
+				}
+			}
+			if(this->readChunk_(in) == 0) {
+				return false;
+			}
+		}
+	}
+
+	/**
+	 * @brief Position of the `,` or `]` that ends the element of the list at the top that starts
+	 * at \a pos, reading more of \a in as needed. Only brackets and strings are tracked; the
+	 * element is checked once it is parsed.
+	 */
+	std::size_t findElementEnd_(std::istream& in, std::size_t pos) {
+		std::size_t depth     = 0;
+		bool        in_string = false;
+		while(true) {
+			while(pos < this->text_.size()) {
+				if(in_string) {
+					pos += findStringEnd(std::string_view(this->text_).substr(pos));
+					if(pos == this->text_.size()) {
+						break;
+					}
+
+					auto const c = this->text_[pos];
+					if(c == '\\') {
+						if(pos + 1 == this->text_.size()) {
+							// The escaped character is not read yet.
+							break;
+						}
+
+						pos += 2;
+						continue;
+					}
+					if(c == '"') {
+						in_string = false;
+					}
+
+					++pos;
+					continue;
+				}
+
+				switch(this->text_[pos]) {
+				case '"': {
+					in_string = true;
+					break;
+				}
+
+				case '{':
+				case '[': {
+					++depth;
+					break;
+				}
+
+				case '}': {
+					if(depth == 0) {
+						throw std::invalid_argument("invalid JSON: unexpected character at offset " + std::to_string(pos));
+					}
+
+					--depth;
+					break;
+				}
+
+				case ']': {
+					if(depth == 0) {
+						return pos;
+					}
+
+					--depth;
+					break;
+				}
+
+				case ',': {
+					if(depth == 0) {
+						return pos;
+					}
+					break;
+				}
+
+				default: {
+					break;
+				}
+				}
+
+				++pos;
+			}
+
+			if(this->readChunk_(in) == 0) {
+				throw std::invalid_argument("invalid JSON: unexpected end of the document");
+			}
+		}
+	}
+
+	/**
+	 * @brief Checks that nothing but spaces follows the list at the top.
+	 */
+	void finish_(std::istream& in, std::size_t pos) {
+		if(this->skipSpaces_(in, pos)) {
+			throw std::invalid_argument("invalid JSON: unexpected character after the document");
+		}
+	}
+
+	// Kept between loads so their capacity is reused.
+	std::string text_;
+	std::string scratch_;
+
+	SymbolCache symbols_;
+};
+
+/**
+ * @brief Read-only Source over a value of a JSON document that is parsed as it is read.
+ *
+ * A value is parsed into a Dom the first time it is read, unless it is a large map or list; such
+ * one is only scanned for the ranges of its children, each of which is read the same way.
+ */
+class LazyJsonSource: public Source {
+   public:
+	struct Document {
+		std::shared_ptr<void const> owner;
+		std::string_view            text;
+	};
+
+	LazyJsonSource(std::shared_ptr<Document const> doc, std::size_t begin, std::size_t end)
+	    : doc(std::move(doc))
+	    , begin(begin)
+	    , end(end) { }
+
+	std::shared_ptr<Source> next(Reference&& ref) override {
+		return this->next(std::as_const(ref));
+	}
+
+	std::shared_ptr<Source> next(Reference const& ref) override {
+		auto next = std::as_const(*this).next(ref);
+		if(next == nullptr) {
+			return Source::null();
+		}
+
+		return next;
+	}
+
+	std::shared_ptr<Source> next(Reference const& ref) const override {
+		auto const& index = this->index_();
+		if(index.parsed) {
+			return std::as_const(*index.parsed).next(ref);
+		}
+
+		auto const pos = this->find_(index, ref);
+		if(pos == Npos) {
+			return nullptr;
+		}
+
+		return this->child_(pos);
+	}
+
+	void keys(std::function<bool(std::string const& key)> const& functor) const override {
+		auto const& index = this->index_();
+		if(index.parsed) {
+			return index.parsed->keys(functor);
+		}
+
+		for(auto const& key: index.keys) {
+			if(!functor(key.str())) {
+				return;
+			}
+		}
+	}
+
+	std::size_t size() const override {
+		auto const& index = this->index_();
+		if(index.parsed) {
+			return index.parsed->size();
+		}
+
+		return index.ranges.size();
+	}
+
+	bool has(Reference const& ref) const override {
+		auto const& index = this->index_();
+		if(index.parsed) {
+			return index.parsed->has(ref);
+		}
+
+		return this->find_(index, ref) != Npos;
+	}
+
+	bool is(Type type) const override {
+		auto const& index = this->index_();
+		if(index.parsed) {
+			return index.parsed->is(type);
+		}
+
+		return type == (index.is_map ? Type::Map : Type::List);
+	}
+
+	// clang-format off
+	bool get(StorageOf<Type::Nil>   value) const override { return this->get_(value); }
+	bool get(StorageOf<Type::Bool>& value) const override { return this->get_(value); }
+	bool get(StorageOf<Type::Int>&  value) const override { return this->get_(value); }
+	bool get(StorageOf<Type::Num>&  value) const override { return this->get_(value); }
+	bool get(StorageOf<Type::Str>&  value) const override { return this->get_(value); }
+
+	void set(StorageOf<Type::Nil>)        override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Bool>)       override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Int>)        override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Num>)        override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Str> const&) override { throw detail::InvalidAccessError(); }
+	void set(StorageOf<Type::Str>&&)      override { throw detail::InvalidAccessError(); }
+	// clang-format on
+
+	std::shared_ptr<Document const> doc;
+
+	// Range of the value in the text.
+	std::size_t begin;
+	std::size_t end;
+
+   private:
+	static constexpr std::size_t Npos = static_cast<std::size_t>(-1);
+
+	/**
+	 * @brief Maps and lists of at least this many bytes are scanned instead of being parsed.
+	 */
+	static constexpr std::size_t ScanThreshold = 64 * 1024;
+
+	struct Index {
+		// Set if the value is parsed as a whole.
+		std::shared_ptr<Source const> parsed;
+
+		bool is_map = false;
+
+		// Keys of a map in order; empty for a list.
+		std::vector<Symbol> keys;
+
+		std::vector<std::pair<std::size_t, std::size_t>> ranges;
+		std::unordered_map<Symbol, std::size_t>          positions;
+	};
+
+	Index const& index_() const {
+		// Nothing is set if it throws, so a later read reports the error again.
+		std::call_once(this->once_, [this] {
+			auto const text = this->doc->text.substr(0, this->end);
+			auto const c    = text[this->begin];
+
+			std::string scratch;
+			SymbolCache symbols;
+
+			auto& index = this->index_value_;
+			if((c != '{' && c != '[') || this->end - this->begin < ScanThreshold) {
+				// Strings refer to the text, so the Dom keeps the document alive for Sources
+				// navigated from it.
+				auto dom = std::shared_ptr<Dom>(new Dom(), [doc = this->doc](Dom* dom) { delete dom; });
+				JsonParser(text, scratch, symbols, this->begin).refer().parse(*dom);
+
+				index.parsed = Source::fromDom(std::move(dom));
+				return;
+			}
+
+			index.is_map = c == '{';
+			JsonParser(text, scratch, symbols, this->begin).scan([&](std::string_view key, std::size_t begin, std::size_t end) {
+				if(!index.is_map) {
+					index.ranges.emplace_back(begin, end);
+					return;
+				}
+
+				// A duplicated key keeps its first position and takes the last value.
+				auto const symbol       = symbols.get(key);
+				auto const [it, is_new] = index.positions.try_emplace(symbol, index.ranges.size());
+				if(is_new) {
+					index.keys.push_back(symbol);
+					index.ranges.emplace_back(begin, end);
+				} else {
+					index.ranges[it->second] = {begin, end};
+				}
+			});
+
+			this->children_.resize(index.ranges.size());
+		});
+
+		return this->index_value_;
+	}
+
+	std::size_t find_(Index const& index, Reference const& ref) const {
+		if(index.is_map) {
+			if(!ref.isKey()) {
+				return Npos;
+			}
+
+			// A key that was never interned is not in any map.
+			auto const symbol = Symbol::find(ref.key());
+			if(!symbol.has_value()) {
+				return Npos;
+			}
+
+			auto const it = index.positions.find(*symbol);
+			return it == index.positions.end() ? Npos : it->second;
+		}
+
+		if(!ref.isIndex() || ref.index() >= index.ranges.size()) {
+			return Npos;
+		}
+
+		return ref.index();
+	}
+
+	std::shared_ptr<Source> child_(std::size_t pos) const {
+		std::lock_guard<std::mutex> lock(this->children_mutex_);
+
+		// Kept so that a child is parsed once however many times it is reached.
+		auto& child = this->children_[pos];
+		if(child == nullptr) {
+			auto const [begin, end] = this->index_value_.ranges[pos];
+			child                   = std::make_shared<LazyJsonSource>(this->doc, begin, end);
+		}
+
+		return child;
+	}
+
+	template<typename V>
+	bool get_(V& value) const {
+		auto const& index = this->index_();
+		return index.parsed && index.parsed->get(value);
+	}
+
+	mutable std::once_flag once_;
+	mutable Index          index_value_;
+
+	mutable std::mutex                           children_mutex_;
+	mutable std::vector<std::shared_ptr<Source>> children_;
+};
+
+/**
+ * @brief Records of newline-delimited JSON, one document per line. Lines of only spaces are
+ * skipped.
+ */
+class JsonLineReader {
+   public:
+	JsonLineReader(std::istream& in)
+	    : in_(in) { }
+
+	/**
+	 * @brief Reads the line of the next record.
+	 *
+	 * @return `false` after the last record.
+	 */
+	bool read() {
+		while(std::getline(this->in_, this->line_)) {
+			++this->number_;
+			if(!isBlank(this->line_)) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Line of the record just read. It may be taken until the next `read`.
+	 */
+	std::string& line() {
+		return this->line_;
+	}
+
+	/**
+	 * @brief Number of the line of the record just read, counted from 1.
+	 */
+	std::size_t number() const {
+		return this->number_;
+	}
+
+	/**
+	 * @brief Parses the record just read into the node \a index of \a dom.
+	 *
+	 * @throws std::invalid_argument if the record is not valid JSON; the message tells its line.
+	 */
+	void parse(Dom& dom, Dom::Index index) {
+		JsonLineReader::parse(this->line_, this->number_, dom, index, this->scratch_, this->symbols_);
+	}
+
+	/**
+	 * @brief Parses the record \a line, read as line \a number, into the node \a index of
+	 * \a dom. Lets a record be parsed apart from the reader, e.g. on another thread.
+	 */
+	static void parse(std::string_view line, std::size_t number, Dom& dom, Dom::Index index, std::string& scratch, SymbolCache& symbols) {
+		try {
+			JsonParser(line, scratch, symbols).parse(dom, index);
+		} catch(std::invalid_argument const& error) {
+			throw std::invalid_argument("line " + std::to_string(number) + ": " + error.what());
+		}
+	}
+
+   private:
+	std::istream& in_;
+	std::string   line_;
+	std::size_t   number_ = 0;
+
+	std::string scratch_;
+	SymbolCache symbols_;
+};
+
+class JsonLineDocumentReader: public DocumentReader {
+   public:
+	JsonLineDocumentReader(std::istream& in)
+	    : reader_(in) { }
+
+	std::shared_ptr<Source> next() override {
+		if(!this->reader_.read()) {
+			return nullptr;
+		}
+
+		auto dom = std::make_shared<Dom>();
+		this->reader_.parse(*dom, dom->root());
+		return Source::fromDom(std::move(dom));
+	}
+
+   private:
+	JsonLineReader reader_;
+};
+
+/**
+ * @brief Loads newline-delimited JSON, also known as JSON Lines, as a list of its records.
+ */
+class JsonLinesLoader: public Loader {
+   public:
+	using Loader::load;
+
+	std::shared_ptr<Source> load(std::istream& in) override {
+		auto dom = std::make_shared<Dom>();
+		dom->reset(dom->root(), Type::List);
+
+		JsonLineReader reader(in);
+		while(reader.read()) {
+			reader.parse(*dom, dom->append(dom->root()));
+		}
+
+		return Source::fromDom(std::move(dom));
+	}
+
+	/**
+	 * @brief Reads each record as a document.
+	 */
+	std::unique_ptr<DocumentReader> documents(std::istream& in) override {
+		return std::make_unique<JsonLineDocumentReader>(in);
+	}
+
+	/**
+	 * @brief Reads the records one line at a time.
+	 */
+	void elements(std::istream& in, detail::FunctionRef<bool(Source::Cursor const& element)> functor) override {
+		auto const dom = std::make_shared<Dom>();
+		auto const src = Source::fromDom(dom);
+
+		JsonLineReader reader(in);
+		while(reader.read()) {
+			dom->clear();
+			reader.parse(*dom, dom->root());
+			if(!functor(Source::Cursor(*src))) {
+				return;
+			}
+		}
+	}
+};
+
+class JsonLoaderFactory: public LoaderFactory {
+   public:
+	std::string name() const {
+		return "json";
+	}
+
+	std::shared_ptr<Loader> make() const {
+		return std::make_shared<JsonLoader>();
+	}
+};
+
+class JsonLinesLoaderFactory: public LoaderFactory {
+   public:
+	std::string name() const {
+		return "ndjson";
+	}
+
+	std::shared_ptr<Loader> make() const {
+		return std::make_shared<JsonLinesLoader>();
+	}
+};
+
+void* const _ = ([] {
+	loader_registry::add(std::make_shared<JsonLoaderFactory>());
+	loader_registry::add(std::make_shared<JsonLinesLoaderFactory>());
+	loader_registry::add("jsonl", std::make_shared<JsonLinesLoaderFactory>());
+	return nullptr;
+})();
+
+}  // namespace
+
+namespace load {
+
+std::shared_ptr<Source> parseJsonLazily(std::string_view data, std::shared_ptr<void const> owner) {
+	auto begin = std::size_t(0);
+	auto end   = data.size();
+	while(begin < end && isSpace(data[begin])) {
+		++begin;
+	}
+	while(end > begin && isSpace(data[end - 1])) {
+		--end;
+	}
+	if(begin == end) {
+		return Source::fromDom(std::make_shared<Dom>());
+	}
+
+	auto doc = std::make_shared<LazyJsonSource::Document>(LazyJsonSource::Document{.owner = std::move(owner), .text = data});
+	return std::make_shared<LazyJsonSource>(std::move(doc), begin, end);
+}
+
+std::shared_ptr<Source> fromJsonLazily(std::filesystem::path const& path) {
+	auto file = detail::MappedFile::open(path);
+
+	auto const bytes = file->bytes();
+	return parseJsonLazily(std::string_view(reinterpret_cast<char const*>(bytes.data()), bytes.size()), std::move(file));
+}
+
+void jsonLines(std::istream& in, std::size_t batch_size, detail::FunctionRef<void(std::size_t slot, Source::Cursor const& record)> visit, detail::FunctionRef<bool(std::size_t slot)> take, Executor const& executor) {
+	if(batch_size == 0) {
+		throw std::invalid_argument("batch size must be positive");
+	}
+
+	// Records are handed out a few at a time so a small one does not cost a task each.
+	constexpr std::size_t TaskSize = 64;
+
+	struct Record {
+		std::string        text;
+		std::size_t        line;
+		std::exception_ptr error;
+	};
+
+	// Kept between batches so the capacity of the lines is reused.
+	std::vector<Record> records(batch_size);
+
+	JsonLineReader reader(in);
+	while(true) {
+		std::size_t size = 0;
+		while(size < batch_size && reader.read()) {
+			// Swapped so the line read next reuses the capacity of the record.
+			std::swap(records[size].text, reader.line());
+			records[size].line  = reader.number();
+			records[size].error = nullptr;
+			++size;
+		}
+		if(size == 0) {
+			return;
+		}
+
+		auto const tasks = (size + TaskSize - 1) / TaskSize;
+
+		std::latch done(static_cast<std::ptrdiff_t>(tasks));
+		for(std::size_t t = 0; t < tasks; ++t) {
+			try {
+				executor([&, t] {
+					auto const dom = std::make_shared<Dom>();
+					auto const src = Source::fromDom(dom);
+
+					std::string scratch;
+					SymbolCache symbols;
+					for(auto i = t * TaskSize; i < std::min(size, (t + 1) * TaskSize); ++i) {
+						auto& record = records[i];
+						try {
+							dom->clear();
+							JsonLineReader::parse(record.text, record.line, *dom, dom->root(), scratch, symbols);
+							visit(i, Source::Cursor(*src));
+						} catch(...) {
+							record.error = std::current_exception();
+						}
+					}
+					done.count_down();
+				});
+			} catch(...) {
+				// Tasks already submitted refer to this frame.
+				done.count_down(static_cast<std::ptrdiff_t>(tasks - t));
+				done.wait();
+				throw;
+			}
+		}
+		done.wait();
+
+		for(std::size_t i = 0; i < size; ++i) {
+			if(records[i].error) {
+				std::rethrow_exception(records[i].error);
+			}
+			if(!take(i)) {
+				return;
+			}
+		}
+		if(size < batch_size) {
+			return;
+		}
+	}
+}
+
+}  // namespace load
+
+}  // namespace cray
@@ -1,152 +1,521 @@
 #include "cray/load.hpp"
 
 #include <cstddef>
-#include <functional>
+#include <istream>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
-#include <type_traits>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include <yaml-cpp/eventhandler.h>
 #include <yaml-cpp/yaml.h>
 
+#include "cray/dom.hpp"
 #include "cray/source.hpp"
+#include "cray/symbol.hpp"
 #include "cray/types.hpp"
+#include "cray/writer.hpp"
 
 namespace cray {
 namespace {
 
-class YamlSource: public Source {
+/**
+ * @brief Whether a scalar of \a tag is plain, so its type is resolved from its text. Quoted
+ * scalars are tagged `!`.
+ */
+bool isPlain(std::string const& tag) {
+	return tag != "!" && tag != "tag:yaml.org,2002:str";
+}
+
+/**
+ * @brief Most nodes that the aliases of a document may expand to in total. Each alias is a copy
+ * of its anchored node, so aliases of aliases grow exponentially, e.g. "billion laughs".
+ */
+constexpr std::size_t MaxAliasExpansion = 1 << 20;
+
+/**
+ * @brief Key that a null key, e.g. `~`, `null`, or an empty one, is read as, as yaml-cpp reads a
+ * null node as a string.
+ */
+constexpr char const* NullKey = "null";
+
+/**
+ * @brief Builds a Dom from the events of a single document.
+ */
+class DomBuilder: public YAML::EventHandler {
    public:
-	YamlSource(YAML::Node const& node)
-	    : node(std::move(node)) { }
-
-	std::shared_ptr<Source> next(Reference&& ref) override {
-		return this->next(std::as_const(ref));
-	}
-
-	std::shared_ptr<Source> next(Reference const& ref) override {
-		return ref.visit([this](auto const& value) -> std::shared_ptr<Source> {
-			if constexpr(Reference::IsIndex<decltype(value)>) {
-				if(!this->node.IsSequence()) {
-					this->node = YAML::Node(YAML::NodeType::Sequence);
-				}
-
-				// TODO: yaml-cpp replaces seq into map if index jumps.
-				// How about replacing YAML lib with something else?
-				auto size = this->node.size();
-				for(; size < value; ++size) {
-					this->node.push_back(YAML::NodeType::Null);
-				}
-			} else if constexpr(Reference::IsKey<decltype(value)>) {
-				if(!this->node.IsMap()) {
-					this->node = YAML::Node(YAML::NodeType::Map);
-				}
+	void OnDocumentStart(YAML::Mark const& mark) override {
+		this->dom_ = std::make_shared<Dom>();
+		this->frames_.clear();
+		this->anchors_.clear();
+		this->key_anchors_.clear();
+		this->expanded_ = 0;
+	}
+
+	void OnDocumentEnd() override { }
+
+	void OnNull(YAML::Mark const& mark, YAML::anchor_t anchor) override {
+		if(this->isKeyNext_()) {
+			Symbol const key(NullKey);
+			if(anchor != 0) {
+				this->key_anchors_.insert_or_assign(anchor, KeyAnchor{.key = key, .is_plain = true, .is_null = true});
 			}
 
-			return std::make_shared<YamlSource>(this->node[value]);
-		});
+			this->frames_.back().key = key;
+			return;
+		}
+
+		this->dom_->set(this->add_(anchor), nullptr);
 	}
 
-	std::shared_ptr<Source> next(Reference const& ref) const override {
-		auto next_node = this->find_(ref);
-		if(!next_node.IsDefined()) {
-			return nullptr;
+	void OnAlias(YAML::Mark const& mark, YAML::anchor_t anchor) override {
+		auto const it = this->key_anchors_.find(anchor);
+		if(it != this->key_anchors_.end()) {
+			auto const& [key, is_plain, is_null] = it->second;
+			if(this->isKeyNext_()) {
+				this->frames_.back().key = key;
+				return;
+			}
+
+			// A value that is a copy of an anchored key.
+			auto const index = this->add_(0);
+			if(is_null) {
+				this->dom_->set(index, nullptr);
+			} else if(is_plain) {
+				this->dom_->setPlain(index, key.str());
+			} else {
+				this->dom_->set(index, key.str());
+			}
+			return;
 		}
 
-		return std::static_pointer_cast<Source>(std::make_shared<YamlSource>(std::move(next_node)));
-	}
+		auto const node = this->anchors_.at(anchor);
+		if(this->isKeyNext_()) {
+			if(!this->dom_->is(node, Type::Str)) {
+				throw std::invalid_argument("keys of a YAML map must be scalars");
+			}
+
+			this->frames_.back().key = Symbol(this->dom_->str(node));
+			return;
+		}
+
+		for(auto const& frame: this->frames_) {
+			if(frame.index == node) {
+				throw std::invalid_argument("YAML alias refers to its own ancestor");
+			}
+		}
 
-	void keys(std::function<bool(std::string const& key)> const& functor) const override {
-		for(auto const& next_node: this->node) {
-			auto key = next_node.first.as<std::string>();
-			functor(key);
+		this->expanded_ += this->count_(node, MaxAliasExpansion - this->expanded_ + 1);
+		if(this->expanded_ > MaxAliasExpansion) {
+			throw std::invalid_argument("YAML aliases expand to too many nodes");
 		}
+
+		this->dom_->graft(this->add_(0), *this->dom_, node);
 	}
 
-	std::size_t size() const override {
-		if(!(this->node.IsMap() || this->node.IsSequence())) {
-			return 0;
+	void OnScalar(YAML::Mark const& mark, std::string const& tag, YAML::anchor_t anchor, std::string const& value) override {
+		if(this->isKeyNext_()) {
+			Symbol const key(value);
+			if(anchor != 0) {
+				this->key_anchors_.insert_or_assign(anchor, KeyAnchor{.key = key, .is_plain = isPlain(tag), .is_null = false});
+			}
+
+			this->frames_.back().key = key;
+			return;
 		}
 
-		return this->node.size();
+		auto const index = this->add_(anchor);
+		if(isPlain(tag)) {
+			this->dom_->setPlain(index, value);
+		} else {
+			this->dom_->set(index, value);
+		}
 	}
 
-	bool has(Reference const& ref) const override {
-		return this->find_(ref).IsDefined();
+	void OnSequenceStart(YAML::Mark const& mark, std::string const& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override {
+		this->begin_(Type::List, anchor);
 	}
 
-	bool is(Type t) const override {
-		switch(t) {
-		case Type::Nil: return this->node.IsNull();
-		case Type::Bool: return this->has_<bool>();
-		case Type::Int: return this->has_<int>();
-		case Type::Num: return this->has_<double>();
-		case Type::Str: return this->node.IsScalar();
-		case Type::Map: return this->node.IsMap();
-		case Type::List: return this->node.IsSequence();
+	void OnSequenceEnd() override {
+		this->frames_.pop_back();
+	}
 
-		default: throw detail::InvalidTypeError(t);
-		}
+	void OnMapStart(YAML::Mark const& mark, std::string const& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override {
+		this->begin_(Type::Map, anchor);
 	}
 
-	// clang-format off
-	bool get(StorageOf<Type::Nil>   value) const override { return this->node.IsNull(); }
-	bool get(StorageOf<Type::Bool>& value) const override { return this->get_(value); }
-	bool get(StorageOf<Type::Int>&  value) const override { return this->get_(value); }
-	bool get(StorageOf<Type::Num>&  value) const override { return this->get_(value); }
-	bool get(StorageOf<Type::Str>&  value) const override { return this->get_(value); }
+	void OnMapEnd() override {
+		this->frames_.pop_back();
+	}
 
-	void set(StorageOf<Type::Nil>        value) override { this->node = YAML::Null; }
-	void set(StorageOf<Type::Bool>       value) override { this->node = value; }
-	void set(StorageOf<Type::Int>        value) override { this->node = value; }
-	void set(StorageOf<Type::Num>        value) override { this->node = value; }
-	void set(StorageOf<Type::Str> const& value) override { this->node = value; }
-	void set(StorageOf<Type::Str>&&      value) override { this->node = std::move(value); }
-	// clang-format on
+	/**
+	 * @brief Dom of the last document. A Dom of `nil` if no document is read.
+	 */
+	std::shared_ptr<Dom> dom() const {
+		if(this->dom_ == nullptr) {
+			return std::make_shared<Dom>();
+		}
 
-	YAML::Node node;
+		return this->dom_;
+	}
 
    private:
-	template<typename V>
-	bool get_(V& value) const {
-		try {
-			value = this->node.as<V>();
-		} catch(...) {
+	struct Frame {
+		Dom::Index index;
+
+		// Key of a map waiting for its value.
+		std::optional<Symbol> key;
+	};
+
+	struct KeyAnchor {
+		Symbol key;
+		bool   is_plain;
+		bool   is_null;
+	};
+
+	/**
+	 * @return Number of nodes in the subtree of \a node, counted up to \a limit.
+	 */
+	std::size_t count_(Dom::Index node, std::size_t limit) const {
+		std::size_t count = 0;
+
+		std::vector<Dom::Index> stack{node};
+		while(!stack.empty() && count < limit) {
+			auto const curr = stack.back();
+			stack.pop_back();
+			++count;
+
+			auto const size = this->dom_->size(curr);
+			for(std::size_t i = 0; i < size; ++i) {
+				stack.push_back(this->dom_->at(curr, i));
+			}
+		}
+
+		return count;
+	}
+
+	bool isKeyNext_() const {
+		if(this->frames_.empty()) {
 			return false;
 		}
-		return true;
+
+		auto const& frame = this->frames_.back();
+		return this->dom_->is(frame.index, Type::Map) && !frame.key.has_value();
+	}
+
+	void begin_(Type type, YAML::anchor_t anchor) {
+		if(this->isKeyNext_()) {
+			throw std::invalid_argument("keys of a YAML map must be scalars");
+		}
+
+		auto const index = this->add_(anchor);
+		this->dom_->reset(index, type);
+		this->frames_.push_back(Frame{.index = index, .key = std::nullopt});
+	}
+
+	/**
+	 * @return Index of a new node in the current container, or of the root.
+	 */
+	Dom::Index add_(YAML::anchor_t anchor) {
+		if(this->isKeyNext_()) {
+			throw std::invalid_argument("keys of a YAML map must be scalars");
+		}
+
+		Dom::Index index = this->dom_->root();
+		if(!this->frames_.empty()) {
+			auto& frame = this->frames_.back();
+			if(frame.key.has_value()) {
+				index = this->dom_->child(frame.index, *frame.key);
+				frame.key.reset();
+			} else {
+				index = this->dom_->append(frame.index);
+			}
+		}
+
+		if(anchor != 0) {
+			this->anchors_.insert_or_assign(anchor, index);
+		}
+
+		return index;
+	}
+
+	std::shared_ptr<Dom> dom_;
+	std::vector<Frame>   frames_;
+
+	std::unordered_map<YAML::anchor_t, Dom::Index> anchors_;
+
+	// Anchored keys, which have no node.
+	std::unordered_map<YAML::anchor_t, KeyAnchor> key_anchors_;
+
+	// Number of nodes copied for aliases so far.
+	std::size_t expanded_ = 0;
+};
+
+/**
+ * @brief Forwards the events of a single document to a Writer. Anchored nodes are recorded so
+ * that their aliases can be replayed.
+ */
+class EventForwarder: public YAML::EventHandler {
+   public:
+	EventForwarder(Writer& dst)
+	    : dst_(dst) { }
+
+	void OnDocumentStart(YAML::Mark const& mark) override {
+		this->expanded_ = 0;
+	}
+
+	void OnDocumentEnd() override { }
+
+	void OnNull(YAML::Mark const& mark, YAML::anchor_t anchor) override {
+		this->handle_(Event{.kind = Event::Null}, anchor);
+	}
+
+	void OnAlias(YAML::Mark const& mark, YAML::anchor_t anchor) override {
+		auto const& recorded = this->anchors_.at(anchor);
+
+		// Counted in events, of which a node has one or two.
+		this->expanded_ += recorded.size();
+		if(this->expanded_ > 2 * MaxAliasExpansion) {
+			throw std::invalid_argument("YAML aliases expand to too many nodes");
+		}
+
+		// Copied since a replayed event may be recorded into another anchor.
+		auto const events = recorded;
+		for(auto const& event: events) {
+			this->handle_(event, 0);
+		}
+	}
+
+	void OnScalar(YAML::Mark const& mark, std::string const& tag, YAML::anchor_t anchor, std::string const& value) override {
+		this->handle_(Event{.kind = Event::Scalar, .value = value, .is_plain = isPlain(tag)}, anchor);
+	}
+
+	void OnSequenceStart(YAML::Mark const& mark, std::string const& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override {
+		this->handle_(Event{.kind = Event::SequenceStart}, anchor);
+	}
+
+	void OnSequenceEnd() override {
+		this->handle_(Event{.kind = Event::End}, 0);
+	}
+
+	void OnMapStart(YAML::Mark const& mark, std::string const& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override {
+		this->handle_(Event{.kind = Event::MapStart}, anchor);
+	}
+
+	void OnMapEnd() override {
+		this->handle_(Event{.kind = Event::End}, 0);
 	}
 
-	template<typename V>
-	bool has_() const {
-		V value;
-		return this->get_(value);
+   private:
+	struct Event {
+		enum Kind {
+			Null,
+			Scalar,
+			SequenceStart,
+			MapStart,
+			End,
+		};
+
+		Kind        kind;
+		std::string value = {};
+		bool        is_plain = false;
+	};
+
+	struct Recording {
+		YAML::anchor_t     anchor;
+		std::size_t        depth;
+		std::vector<Event> events;
+	};
+
+	void handle_(Event const& event, YAML::anchor_t anchor) {
+		if(anchor != 0) {
+			this->recordings_.push_back(Recording{.anchor = anchor, .depth = this->depth_(), .events = {}});
+		}
+		for(auto& recording: this->recordings_) {
+			recording.events.push_back(event);
+		}
+
+		this->forward_(event);
+
+		while(!this->recordings_.empty() && this->recordings_.back().depth == this->depth_()) {
+			auto& recording = this->recordings_.back();
+			this->anchors_.insert_or_assign(recording.anchor, std::move(recording.events));
+			this->recordings_.pop_back();
+		}
 	}
 
-	YAML::Node find_(Reference const& ref) const {
-		if(ref.isIndex() && this->node.IsSequence()) {
-			auto const index = ref.index();
-			if(this->node.size() > index) {
-				return node[index];
+	void forward_(Event const& event) {
+		if(this->skip_depth_ > 0) {
+			this->skip_(event);
+			return;
+		}
+
+		bool const is_key = event.kind != Event::End && !this->frames_.empty() && this->frames_.back().is_map && this->frames_.back().is_key_next;
+		if(is_key) {
+			if(event.kind != Event::Scalar && event.kind != Event::Null) {
+				throw std::invalid_argument("keys of a YAML map must be scalars");
+			}
+
+			std::string_view const key = event.kind == Event::Null ? NullKey : event.value;
+			if(!this->dst_.wants(key)) {
+				// The key is taken but its value is dropped, so a key comes next again.
+				this->skip_depth_ = 1;
+				return;
+			}
+
+			this->dst_.key(key);
+			this->frames_.back().is_key_next = false;
+			return;
+		}
+
+		switch(event.kind) {
+		case Event::Null: {
+			this->dst_.value(nullptr);
+			break;
+		}
+
+		case Event::Scalar: {
+			auto& scalar = *this->scalar_;
+			scalar.clear();
+			if(event.is_plain) {
+				scalar.setPlain(scalar.root(), event.value);
+			} else {
+				scalar.set(scalar.root(), event.value);
 			}
-		} else if(ref.isKey() && this->node.IsMap()) {
-			auto const& key = ref.key();
 
-			auto next_node = this->node[key];
-			if(next_node.IsDefined()) {
-				return next_node;
+			this->dst_.scalar(Source::Cursor(*this->scalar_source_));
+			break;
+		}
+
+		case Event::SequenceStart: {
+			this->dst_.beginList();
+			this->frames_.push_back(Frame{.is_map = false, .is_key_next = false});
+			return;
+		}
+
+		case Event::MapStart: {
+			this->dst_.beginMap();
+			this->frames_.push_back(Frame{.is_map = true, .is_key_next = true});
+			return;
+		}
+
+		case Event::End: {
+			bool const is_map = this->frames_.back().is_map;
+			this->frames_.pop_back();
+			if(is_map) {
+				this->dst_.endMap();
+			} else {
+				this->dst_.endList();
 			}
+			break;
+		}
 		}
 
-		return YAML::Node(YAML::NodeType::Undefined);
+		if(!this->frames_.empty() && this->frames_.back().is_map) {
+			this->frames_.back().is_key_next = true;
+		}
 	}
+
+	/**
+	 * @brief Number of open containers, including those of a value being dropped.
+	 */
+	std::size_t depth_() const {
+		return this->frames_.size() + (this->skip_depth_ > 0 ? this->skip_depth_ - 1 : 0);
+	}
+
+	/**
+	 * @brief Drops an event of a value that is not wanted.
+	 */
+	void skip_(Event const& event) {
+		switch(event.kind) {
+		case Event::SequenceStart:
+		case Event::MapStart: {
+			++this->skip_depth_;
+			break;
+		}
+
+		case Event::End: {
+			--this->skip_depth_;
+			break;
+		}
+
+		default:
+			break;
+		}
+
+		// Depth of 1 is where the value starts, so it is done once back there.
+		if(this->skip_depth_ == 1) {
+			this->skip_depth_ = 0;
+		}
+	}
+
+	struct Frame {
+		bool is_map;
+		bool is_key_next;
+	};
+
+	Writer& dst_;
+
+	// Number of containers opened in a value that is being dropped, plus 1; 0 if none is.
+	std::size_t skip_depth_ = 0;
+
+	// Holds the scalar being forwarded so a Source of it is not made for each one.
+	std::shared_ptr<Dom>    scalar_        = std::make_shared<Dom>();
+	std::shared_ptr<Source> scalar_source_ = Source::fromDom(this->scalar_);
+
+	std::vector<Frame>     frames_;
+	std::vector<Recording> recordings_;
+
+	std::unordered_map<YAML::anchor_t, std::vector<Event>> anchors_;
+
+	// Number of events replayed for aliases so far.
+	std::size_t expanded_ = 0;
+};
+
+class YamlDocumentReader: public DocumentReader {
+   public:
+	YamlDocumentReader(std::istream& in)
+	    : parser_(in) { }
+
+	std::shared_ptr<Source> next() override {
+		if(!this->parser_.HandleNextDocument(this->builder_)) {
+			return nullptr;
+		}
+
+		return Source::fromDom(this->builder_.dom());
+	}
+
+   private:
+	YAML::Parser parser_;
+	DomBuilder   builder_;
 };
 
 class YamlLoader: public Loader {
    public:
+	using Loader::load;
+
 	std::shared_ptr<Source> load(std::istream& in) override {
-		YAML::Node node = YAML::Load(in);
-		return std::static_pointer_cast<Source>(std::make_shared<YamlSource>(std::move(node)));
+		YAML::Parser parser(in);
+		DomBuilder   builder;
+		parser.HandleNextDocument(builder);
+
+		return Source::fromDom(builder.dom());
+	}
+
+	std::unique_ptr<DocumentReader> documents(std::istream& in) override {
+		return std::make_unique<YamlDocumentReader>(in);
+	}
+
+	void emit(std::istream& in, Writer& dst) override {
+		YAML::Parser   parser(in);
+		EventForwarder forwarder(dst);
+		if(!parser.HandleNextDocument(forwarder)) {
+			dst.value(nullptr);
+		}
 	}
 };
 
@@ -162,9 +531,7 @@ class YamlLoaderFactory: public LoaderFactory {
 };
 
 void* const _ = ([] {
-	auto factory = std::make_shared<YamlLoaderFactory>();
-	loader_registry::add("yaml", factory);
-	loader_registry::add("json", factory);
+	loader_registry::add(std::make_shared<YamlLoaderFactory>());
 	return nullptr;
 })();
 
@@ -0,0 +1,88 @@
+#include "cray/detail/mapped_file.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+
+	#define CRAY_HAS_MMAP 1
+#endif
+
+namespace cray {
+namespace detail {
+
+namespace {
+
+void readAll(std::filesystem::path const& path, std::vector<std::byte>& dst) {
+	std::ifstream in(path, std::ios::binary);
+	if(!in) {
+		throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path.string());
+	}
+
+	char buf[1 << 16];
+	while(in.read(buf, sizeof(buf)) || in.gcount() > 0) {
+		auto const* const first = reinterpret_cast<std::byte const*>(buf);
+		dst.insert(dst.end(), first, first + in.gcount());
+	}
+	if(in.bad()) {
+		throw std::system_error(std::make_error_code(std::errc::io_error), path.string());
+	}
+}
+
+}  // namespace
+
+std::shared_ptr<MappedFile const> MappedFile::open(std::filesystem::path const& path) {
+	auto file = std::shared_ptr<MappedFile>(new MappedFile());
+
+#ifdef CRAY_HAS_MMAP
+	int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0) {
+		throw std::system_error(errno, std::generic_category(), path.string());
+	}
+
+	struct stat st;
+	if(::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		auto const size = static_cast<std::size_t>(st.st_size);
+
+		void* const addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(addr != MAP_FAILED) {
+			::close(fd);
+
+			// Loaders read the file front to back once.
+			::madvise(addr, size, MADV_SEQUENTIAL);
+
+			file->data_      = static_cast<std::byte const*>(addr);
+			file->size_      = size;
+			file->is_mapped_ = true;
+			return file;
+		}
+	}
+
+	::close(fd);
+#endif
+
+	readAll(path, file->buffer_);
+	file->data_ = file->buffer_.data();
+	file->size_ = file->buffer_.size();
+	return file;
+}
+
+MappedFile::~MappedFile() {
+#ifdef CRAY_HAS_MMAP
+	if(this->is_mapped_) {
+		::munmap(const_cast<std::byte*>(this->data_), this->size_);
+	}
+#endif
+}
+
+}  // namespace detail
+}  // namespace cray
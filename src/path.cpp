@@ -0,0 +1,192 @@
+#include "cray/path.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "cray/source.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+namespace {
+
+bool isIndexToken(std::string_view token) {
+	if(token.empty() || (token.size() > 1 && token.front() == '0')) {
+		return false;
+	}
+
+	return std::ranges::all_of(token, [](char c) { return '0' <= c && c <= '9'; });
+}
+
+std::size_t toIndex(std::string_view token) {
+	std::size_t index = 0;
+
+	auto const [end, ec] = std::from_chars(token.data(), token.data() + token.size(), index);
+	if(ec != std::errc() || end != token.data() + token.size()) {
+		throw std::invalid_argument("invalid index: " + std::string(token));
+	}
+
+	return index;
+}
+
+}  // namespace
+
+Path::Path(std::vector<Reference> refs)
+    : refs_(std::move(refs))
+    , hints_(this->refs_.size(), 0) { }
+
+Path Path::parse(std::string_view path) {
+	if(path.empty() || path.front() == '/') {
+		return Path::fromPointer(path);
+	} else {
+		return Path::fromDotted(path);
+	}
+}
+
+Path Path::fromPointer(std::string_view pointer) {
+	std::vector<Reference> refs;
+	if(pointer.empty()) {
+		return Path(std::move(refs));
+	}
+
+	if(pointer.front() != '/') {
+		throw std::invalid_argument("JSON Pointer must start with '/'");
+	}
+
+	std::string token;
+
+	std::size_t pos = 1;
+	while(true) {
+		auto const end = std::min(pointer.find('/', pos), pointer.size());
+
+		token.clear();
+		for(auto i = pos; i < end; ++i) {
+			if(pointer[i] != '~') {
+				token.push_back(pointer[i]);
+				continue;
+			}
+
+			if(i + 1 >= end) {
+				throw std::invalid_argument("incomplete escape in JSON Pointer");
+			}
+
+			switch(pointer[++i]) {
+			case '0': token.push_back('~'); break;
+			case '1': token.push_back('/'); break;
+			default: throw std::invalid_argument("invalid escape in JSON Pointer");
+			}
+		}
+
+		if(isIndexToken(token)) {
+			refs.emplace_back(toIndex(token));
+		} else {
+			refs.emplace_back(token);
+		}
+
+		if(end == pointer.size()) {
+			break;
+		}
+
+		pos = end + 1;
+	}
+
+	return Path(std::move(refs));
+}
+
+Path Path::fromDotted(std::string_view path) {
+	std::vector<Reference> refs;
+
+	std::size_t pos = 0;
+	while(pos < path.size()) {
+		if(path[pos] == '[') {
+			auto const end = path.find(']', pos);
+			if(end == std::string_view::npos) {
+				throw std::invalid_argument("unclosed '[' in path");
+			}
+
+			auto const token = path.substr(pos + 1, end - pos - 1);
+			if(!isIndexToken(token)) {
+				throw std::invalid_argument("invalid index in path: " + std::string(token));
+			}
+
+			refs.emplace_back(toIndex(token));
+			pos = end + 1;
+		} else {
+			if(!refs.empty()) {
+				if(path[pos] != '.') {
+					throw std::invalid_argument("expected '.' or '[' in path");
+				}
+
+				++pos;
+			}
+
+			auto const end = std::min(path.find_first_of(".[", pos), path.size());
+			if(end == pos) {
+				throw std::invalid_argument("empty key in path");
+			}
+
+			refs.emplace_back(std::string(path.substr(pos, end - pos)));
+			pos = end;
+		}
+	}
+
+	return Path(std::move(refs));
+}
+
+std::string Path::pointer() const {
+	std::string rst;
+	for(auto const& ref: this->refs_) {
+		rst.push_back('/');
+
+		if(ref.isIndex()) {
+			rst += std::to_string(ref.index());
+			continue;
+		}
+
+		for(auto const c: ref.key()) {
+			switch(c) {
+			case '~': rst += "~0"; break;
+			case '/': rst += "~1"; break;
+			default: rst.push_back(c); break;
+			}
+		}
+	}
+
+	return rst;
+}
+
+Source::Cursor Path::resolve(Source::Cursor const& src) const {
+	auto curr = src;
+	for(std::size_t i = 0; i < this->refs_.size() && curr; ++i) {
+		auto const& ref  = this->refs_[i];
+		auto&       hint = this->hints_[i];
+
+		auto next = curr.next(ref, hint);
+		if(!next && ref.isIndex() && curr.is(Type::Map)) {
+			next = curr.next(std::to_string(ref.index()), hint);
+		}
+
+		curr = std::move(next);
+	}
+
+	return curr;
+}
+
+bool Path::operator==(Path const& other) const {
+	return std::ranges::equal(this->refs_, other.refs_, [](Reference const& lhs, Reference const& rhs) {
+		if(lhs.isIndex() != rhs.isIndex()) {
+			return false;
+		}
+
+		return lhs.isIndex() ? (lhs.index() == rhs.index()) : (lhs.key() == rhs.key());
+	});
+}
+
+}  // namespace cray
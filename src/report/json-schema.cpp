@@ -88,7 +88,7 @@ struct ReportContext {
 		if(!prop.required_keys.empty()) {
 			this->fieldA("required", [&] {
 				for(auto const& key: prop.required_keys) {
-					this->value() << std::quoted(key);
+					this->value() << std::quoted(key.str());
 				}
 			});
 		}
@@ -268,9 +268,11 @@ struct ReportContext {
 		if(type == Type::Str) {
 			std::string v;
 
-			std::size_t const size = source->size();
+			Source::Cursor const elems(*source);
+
+			std::size_t const size = elems.size();
 			for(std::size_t i = 0; i < size; ++i) {
-				source->next(i)->get(v);
+				elems.next(i).get(v);
 				if(v.find('\n') != std::string::npos) {
 					is_multiline = true;
 					break;
@@ -0,0 +1,442 @@
+#include "cray/schema.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cray/detail/prop.hpp"
+#include "cray/dom.hpp"
+#include "cray/load.hpp"
+#include "cray/source.hpp"
+#include "cray/symbol.hpp"
+#include "cray/types.hpp"
+#include "cray/writer.hpp"
+
+namespace cray {
+
+namespace {
+
+/**
+ * @brief Thrown by the Checker to stop the loader at the first rejected node.
+ */
+struct Rejected { };
+
+}  // namespace
+
+/**
+ * @brief Checks events against the rules of a Schema as they arrive.
+ */
+class Schema::Checker: public Writer {
+   public:
+	Checker(Schema const& schema)
+	    : schema_(schema) { }
+
+	void beginMap() override {
+		this->begin_(Type::Map);
+	}
+
+	void endMap() override {
+		auto const frame = std::move(this->frames_.back());
+		this->frames_.pop_back();
+		if(frame.rule == npos) {
+			return;
+		}
+
+		auto const& keys = this->schema_.rules_[frame.rule].keys;
+		for(std::size_t i = 0; i < keys.size(); ++i) {
+			if(!frame.seen[i] && !keys[i].is_ok_if_absent) {
+				throw Rejected();
+			}
+		}
+	}
+
+	void beginList() override {
+		this->begin_(Type::List);
+	}
+
+	void endList() override {
+		auto const frame = std::move(this->frames_.back());
+		this->frames_.pop_back();
+		if(frame.rule == npos) {
+			return;
+		}
+
+		if(!this->schema_.rules_[frame.rule].size.contains(frame.size)) {
+			throw Rejected();
+		}
+	}
+
+	void key(std::string_view key) override {
+		auto& frame = this->frames_.back();
+		frame.next  = npos;
+		if(frame.rule == npos) {
+			return;
+		}
+
+		auto const i = this->schema_.find_(frame.rule, key);
+		if(i == npos) {
+			return;
+		}
+
+		frame.seen[i] = true;
+		frame.next    = this->schema_.rules_[frame.rule].keys[i].rule;
+	}
+
+	bool wants(std::string_view key) override {
+		// Values of other keys are not checked.
+		auto const& frame = this->frames_.back();
+		return frame.rule != npos && this->schema_.find_(frame.rule, key) != npos;
+	}
+
+	// clang-format off
+	void value(StorageOf<Type::Nil>  value) override { this->value_(value); }
+	void value(StorageOf<Type::Bool> value) override { this->value_(value); }
+	void value(StorageOf<Type::Int>  value) override { this->value_(value); }
+	void value(StorageOf<Type::Num>  value) override { this->value_(value); }
+	void value(std::string_view      value) override { this->value_(value); }
+	// clang-format on
+
+	void scalar(Source::Cursor const& src) override {
+		auto const rule = this->next_();
+		if(rule == npos) {
+			return;
+		}
+
+		if(!this->schema_.rules_[rule].prop->okFrom(src)) {
+			throw Rejected();
+		}
+	}
+
+   private:
+	struct Frame {
+		// Rule of the container, or `npos` if it is not checked.
+		std::size_t rule;
+
+		// Number of children seen so far.
+		std::size_t size;
+
+		// Rule of the next child of a map, set by its key.
+		std::size_t next;
+
+		// Whether each key of the rule is seen.
+		std::vector<bool> seen;
+	};
+
+	/**
+	 * @brief Rule of the node that comes next.
+	 */
+	std::size_t next_() {
+		if(this->frames_.empty()) {
+			if(this->is_root_done_) {
+				return npos;
+			}
+
+			this->is_root_done_ = true;
+			return 0;
+		}
+
+		auto& frame = this->frames_.back();
+		++frame.size;
+		if(frame.rule == npos) {
+			return npos;
+		}
+
+		auto const& rule = this->schema_.rules_[frame.rule];
+		if(rule.type == Type::List) {
+			return rule.item;
+		}
+
+		return frame.next;
+	}
+
+	void begin_(Type type) {
+		auto rule = this->next_();
+		if(rule != npos && this->schema_.rules_[rule].type != type) {
+			// Checked as a whole as it is not of the type of the rule.
+			if(!this->schema_.rules_[rule].is_ok_if_absent) {
+				throw Rejected();
+			}
+
+			rule = npos;
+		}
+
+		std::vector<bool> seen;
+		if(rule != npos) {
+			seen.resize(this->schema_.rules_[rule].keys.size(), false);
+		}
+
+		this->frames_.push_back(Frame{.rule = rule, .size = 0, .next = npos, .seen = std::move(seen)});
+	}
+
+	template<typename V>
+	void value_(V value) {
+		auto& scalar = *this->scalar_;
+		scalar.clear();
+		scalar.set(scalar.root(), value);
+
+		this->scalar(Source::Cursor(*this->scalar_source_));
+	}
+
+	Schema const& schema_;
+
+	std::vector<Frame> frames_;
+
+	// Holds the scalar being checked so a Source of it is not made for each one.
+	std::shared_ptr<Dom>    scalar_        = std::make_shared<Dom>();
+	std::shared_ptr<Source> scalar_source_ = Source::fromDom(this->scalar_);
+
+	bool is_root_done_ = false;
+};
+
+/**
+ * @brief Builds a Dom of the parts of a document that the rules of a Schema read.
+ */
+class Schema::Builder: public Writer {
+   public:
+	Builder(Schema const& schema)
+	    : schema_(schema) { }
+
+	void beginMap() override {
+		this->begin_(Type::Map);
+	}
+
+	void endMap() override {
+		this->frames_.pop_back();
+	}
+
+	void beginList() override {
+		this->begin_(Type::List);
+	}
+
+	void endList() override {
+		this->frames_.pop_back();
+	}
+
+	bool wants(std::string_view key) override {
+		auto const& frame = this->frames_.back();
+		if(frame.rule == npos || !this->schema_.rules_[frame.rule].is_closed) {
+			return true;
+		}
+
+		return this->schema_.find_(frame.rule, key) != npos;
+	}
+
+	void key(std::string_view key) override {
+		auto& frame = this->frames_.back();
+		frame.key   = Symbol(key);
+		frame.next  = npos;
+		if(frame.rule == npos) {
+			return;
+		}
+
+		auto const i = this->schema_.find_(frame.rule, key);
+		if(i != npos) {
+			frame.next = this->schema_.rules_[frame.rule].keys[i].rule;
+		}
+	}
+
+	// clang-format off
+	void value(StorageOf<Type::Nil>  value) override { this->dom_->set(this->place_(), value); }
+	void value(StorageOf<Type::Bool> value) override { this->dom_->set(this->place_(), value); }
+	void value(StorageOf<Type::Int>  value) override { this->dom_->set(this->place_(), value); }
+	void value(StorageOf<Type::Num>  value) override { this->dom_->set(this->place_(), value); }
+	void value(std::string_view      value) override { this->dom_->set(this->place_(), value); }
+	// clang-format on
+
+	void scalar(Source::Cursor const& src) override {
+		// A string that reads as other types too is kept as such.
+		bool const is_plain = src.is(Type::Str) && (src.is(Type::Bool) || src.is(Type::Int) || src.is(Type::Num));
+		if(!is_plain) {
+			return Writer::scalar(src);
+		}
+
+		StorageOf<Type::Str> value;
+		src.get(value);
+		this->dom_->setPlain(this->place_(), value);
+	}
+
+	std::shared_ptr<Dom> dom() const {
+		return this->dom_;
+	}
+
+   private:
+	struct Frame {
+		Dom::Index index;
+
+		// Rule of the container, or `npos` if it is loaded in full.
+		std::size_t rule;
+
+		// Key and rule of the next child of a map.
+		Symbol      key;
+		std::size_t next;
+	};
+
+	void begin_(Type type) {
+		auto rule = npos;
+		if(this->frames_.empty()) {
+			rule = 0;
+		} else if(auto const& frame = this->frames_.back(); frame.rule != npos) {
+			auto const& parent = this->schema_.rules_[frame.rule];
+			rule               = parent.type == Type::List ? parent.item : frame.next;
+		}
+		if(rule != npos && this->schema_.rules_[rule].type != type) {
+			rule = npos;
+		}
+
+		auto const index = this->place_();
+		this->dom_->reset(index, type);
+		this->frames_.push_back(Frame{.index = index, .rule = rule, .key = Symbol(), .next = npos});
+	}
+
+	/**
+	 * @return Index of a new node in the innermost container, or of the root.
+	 */
+	Dom::Index place_() {
+		if(this->frames_.empty()) {
+			return this->dom_->root();
+		}
+
+		auto const& frame = this->frames_.back();
+		if(this->dom_->is(frame.index, Type::List)) {
+			return this->dom_->append(frame.index);
+		}
+
+		return this->dom_->child(frame.index, frame.key);
+	}
+
+	Schema const& schema_;
+
+	std::shared_ptr<Dom> dom_ = std::make_shared<Dom>();
+	std::vector<Frame>   frames_;
+};
+
+Schema::Schema(std::shared_ptr<detail::Prop const> prop)
+    : prop_(std::move(prop)) {
+	this->compile_(*this->prop_);
+}
+
+bool Schema::check(Source::Cursor const& src) const {
+	Checker checker(*this);
+	try {
+		checker.write(src);
+	} catch(Rejected const&) {
+		return false;
+	}
+
+	return true;
+}
+
+bool Schema::check(Loader& loader, std::istream& in) const {
+	Checker checker(*this);
+	try {
+		loader.emit(in, checker);
+	} catch(Rejected const&) {
+		return false;
+	}
+
+	return true;
+}
+
+bool Schema::check(std::string const& name, std::istream& in) const {
+	auto const loader = loader_registry::acquire(name);
+	if(loader == nullptr) {
+		throw std::invalid_argument("no loader named " + name);
+	}
+
+	return this->check(*loader, in);
+}
+
+std::shared_ptr<Source> Schema::load(Loader& loader, std::istream& in) const {
+	Builder builder(*this);
+	loader.emit(in, builder);
+
+	return Source::fromDom(builder.dom());
+}
+
+std::shared_ptr<Source> Schema::load(std::string const& name, std::istream& in) const {
+	auto const loader = loader_registry::acquire(name);
+	if(loader == nullptr) {
+		throw std::invalid_argument("no loader named " + name);
+	}
+
+	return this->load(*loader, in);
+}
+
+std::size_t Schema::compile_(detail::Prop const& prop) {
+	auto const index = this->rules_.size();
+	this->rules_.push_back(Rule{
+	    .prop            = &prop,
+	    .type            = prop.type(),
+	    .is_ok_if_absent = prop.okFrom(Source::Cursor()),
+	    .keys            = {},
+	});
+
+	switch(this->rules_[index].type) {
+	case Type::Map: {
+		auto const* holder = dynamic_cast<detail::KeyedPropHolder const*>(&prop);
+		if(holder == nullptr) {
+			break;
+		}
+
+		std::vector<Key> keys;
+		if(holder->isMono()) {
+			// Values of a mono map are not checked by the Prop either.
+			for(auto const& key: holder->required_keys) {
+				keys.push_back(Key{.key = key, .rule = npos, .is_ok_if_absent = false});
+			}
+		} else {
+			holder->forEachDeclared([&](Symbol const& key, detail::Prop const& next) {
+				auto const rule = this->compile_(next);
+				keys.push_back(Key{.key = key, .rule = rule, .is_ok_if_absent = this->rules_[rule].is_ok_if_absent});
+			});
+			this->rules_[index].is_closed = true;
+		}
+
+		this->rules_[index].keys = std::move(keys);
+		break;
+	}
+
+	case Type::List: {
+		auto const* holder = dynamic_cast<detail::IndexedPropHolder const*>(&prop);
+		if(holder == nullptr) {
+			break;
+		}
+
+		auto const next = holder->at(Reference());
+		auto const item = next == nullptr ? npos : this->compile_(*next);
+
+		this->rules_[index].item = item;
+		this->rules_[index].size = holder->interval();
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	return index;
+}
+
+std::size_t Schema::find_(std::size_t rule, std::string_view key) const {
+	// A key that was never interned cannot be one of the rule.
+	auto const symbol = Symbol::find(key);
+	if(!symbol.has_value()) {
+		return npos;
+	}
+
+	auto const& keys = this->rules_[rule].keys;
+	for(std::size_t i = 0; i < keys.size(); ++i) {
+		if(keys[i].key == *symbol) {
+			return i;
+		}
+	}
+
+	return npos;
+}
+
+}  // namespace cray
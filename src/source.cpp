@@ -1,28 +1,170 @@
 #include "cray/source.hpp"
 
+#include <array>
+#include <chrono>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 
+#include "cray/detail/function_ref.hpp"
+#include "cray/detail/mapped_file.hpp"
 #include "cray/load.hpp"
+#include "cray/types.hpp"
 
 namespace cray {
 
+namespace {
+
+template<typename V>
+bool getEach(Source::Cursor const& list, std::span<V> values) {
+	if(!list.is(Type::List) || list.size() != values.size()) {
+		return false;
+	}
+
+	for(std::size_t i = 0; i < values.size(); ++i) {
+		if(!list.next(i).get(values[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}  // namespace
+
+double LoadStats::throughput() const {
+	auto const seconds = std::chrono::duration<double>(this->elapsed).count();
+	if(seconds <= 0) {
+		return 0;
+	}
+
+	return static_cast<double>(this->bytes) / seconds;
+}
+
 std::shared_ptr<Source> Source::load(std::string const& name, std::istream& in) {
-	auto factory = cray::loader_registry::get(name);
-	if(factory == nullptr) {
+	auto const loader = cray::loader_registry::acquire(name);
+	if(loader == nullptr) {
 		return nullptr;
 	}
 
-	auto loader = factory->make();
 	return loader->load(in);
 }
 
 std::shared_ptr<Source> Source::load(std::string const& name, std::filesystem::path const& path) {
-	std::ifstream f(path);
-	return Source::load(name, f);
+	LoadStats stats;
+	return Source::load(name, path, stats);
+}
+
+std::shared_ptr<Source> Source::load(std::string const& name, std::filesystem::path const& path, LoadStats& stats) {
+	auto const loader = cray::loader_registry::acquire(name);
+	if(loader == nullptr) {
+		return nullptr;
+	}
+
+	auto const file = detail::MappedFile::open(path);
+	auto const data = file->bytes();
+
+	auto const begin  = std::chrono::steady_clock::now();
+	auto       source = loader->load(data);
+
+	stats.bytes   = data.size();
+	stats.elapsed = std::chrono::steady_clock::now() - begin;
+	return source;
+}
+
+std::shared_ptr<Source> Source::parse(std::string const& name, std::string_view data) {
+	auto const loader = cray::loader_registry::acquire(name);
+	if(loader == nullptr) {
+		return nullptr;
+	}
+
+	return loader->load(data);
+}
+
+std::shared_ptr<Source> Source::parse(std::string const& name, std::span<std::byte const> data) {
+	return Source::parse(name, std::string_view(reinterpret_cast<char const*>(data.data()), data.size()));
+}
+
+void Source::entries(detail::FunctionRef<bool(std::string const& key, std::shared_ptr<Source> const& next)> functor) const {
+	this->keys([&](std::string const& key) {
+		auto const next = this->next(key);
+		if(next == nullptr) {
+			return true;
+		}
+
+		return functor(key, next);
+	});
+}
+
+Type Source::Cursor::type() const {
+	static constexpr std::array types{Type::Map, Type::List, Type::Nil, Type::Bool, Type::Int, Type::Num, Type::Str};
+	for(auto const type: types) {
+		if(this->is(type)) {
+			return type;
+		}
+	}
+
+	return Type::Unspecified;
+}
+
+std::shared_ptr<Source> Source::snapshot() const {
+	return Source::persistent(*this);
+}
+
+Source::Cursor Source::nextAt_(Handle handle, Reference const& ref) const {
+	auto next = this->next(ref);
+	if(next == nullptr) {
+		return Cursor();
+	}
+
+	return Cursor(std::move(next));
+}
+
+Source::Cursor Source::nextAt_(Handle handle, Reference const& ref, std::size_t& hint) const {
+	return this->nextAt_(handle, ref);
+}
+
+void Source::keysAt_(Handle handle, std::function<bool(std::string const& key)> const& functor) const {
+	this->keys(functor);
+}
+
+void Source::entriesAt_(Handle handle, detail::FunctionRef<bool(std::string const& key, Cursor const& next)> functor) const {
+	this->entries([&](std::string const& key, std::shared_ptr<Source> const& next) {
+		return functor(key, Cursor(std::shared_ptr<Source const>(next)));
+	});
+}
+
+std::size_t Source::sizeAt_(Handle handle) const {
+	return this->size();
+}
+
+bool Source::hasAt_(Handle handle, Reference const& ref) const {
+	return this->has(ref);
+}
+
+bool Source::isAt_(Handle handle, Type type) const {
+	return this->is(type);
+}
+
+// clang-format off
+bool Source::getAt_(Handle handle, StorageOf<Type::Nil>   value) const { return this->get(value); }
+bool Source::getAt_(Handle handle, StorageOf<Type::Bool>& value) const { return this->get(value); }
+bool Source::getAt_(Handle handle, StorageOf<Type::Int>&  value) const { return this->get(value); }
+bool Source::getAt_(Handle handle, StorageOf<Type::Num>&  value) const { return this->get(value); }
+bool Source::getAt_(Handle handle, StorageOf<Type::Str>&  value) const { return this->get(value); }
+
+// clang-format on
+
+bool Source::getAt_(Handle handle, std::span<StorageOf<Type::Int>> values) const {
+	return getEach(Cursor(*this, handle), values);
+}
+
+bool Source::getAt_(Handle handle, std::span<StorageOf<Type::Num>> values) const {
+	return getEach(Cursor(*this, handle), values);
 }
 
 }  // namespace cray
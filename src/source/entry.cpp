@@ -1,485 +1,532 @@
 #include <cassert>
-#include <concepts>
 #include <cstddef>
 #include <functional>
 #include <initializer_list>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
 
-#include "cray/detail/ordered_map.hpp"
+#include "cray/detail/function_ref.hpp"
+#include "cray/dom.hpp"
 #include "cray/source.hpp"
+#include "cray/symbol.hpp"
 #include "cray/types.hpp"
 
 namespace cray {
 
 namespace {
 
-using ScalarStorage = std::variant<
-    StorageOf<Type::Nil>,
-    StorageOf<Type::Bool>,
-    StorageOf<Type::Int>,
-    StorageOf<Type::Num>,
-    StorageOf<Type::Str>>;
+class DomSource: public Source {
+	friend class EntrySource;
 
-class Entry_: public Source {
    public:
-	virtual void assign(Reference const& ref, std::shared_ptr<Entry_> entry) = 0;
-};
-
-class RootEntry: public Entry_ {
-   public:
-	RootEntry(std::shared_ptr<Entry_> value)
-	    : value(std::move(value)) { }
+	DomSource(std::shared_ptr<Dom> dom, Dom::Index index)
+	    : dom(std::move(dom))
+	    , index(index) { }
+
+	/**
+	 * @brief Construct a Source for a child that does not exist yet. The child is created in
+	 * \a parent on the first write.
+	 */
+	DomSource(std::shared_ptr<Dom> dom, Dom::Index parent, Reference ref)
+	    : dom(std::move(dom))
+	    , parent(parent)
+	    , ref(std::move(ref)) { }
 
 	std::shared_ptr<Source> next(Reference&& ref) override {
-		return this->value;
+		return this->next(std::as_const(ref));
 	}
 
 	std::shared_ptr<Source> next(Reference const& ref) override {
-		return this->value;
-	}
+		auto const curr = this->resolve_(ref.isIndex() ? Type::List : Type::Map);
 
-	std::shared_ptr<Source> next(Reference const& ref) const override {
-		return this->value;
-	}
-
-	void keys(std::function<bool(std::string const& key)> const& functor) const override {
-	}
-
-	std::size_t size() const override {
-		return 0;
-	}
-
-	bool has(Reference const& ref) const override {
-		return value != nullptr;
-	}
+		auto const found = this->find_(curr, ref);
+		if(found == Dom::npos) {
+			return std::make_shared<DomSource>(this->dom, curr, ref);
+		}
 
-	bool is(Type type) const override {
-		return false;
+		return std::make_shared<DomSource>(this->dom, found);
 	}
 
-	// clang-format off
-	bool get(StorageOf<Type::Nil>   value) const override { return false; }
-	bool get(StorageOf<Type::Bool>& value) const override { return false; }
-	bool get(StorageOf<Type::Int>&  value) const override { return false; }
-	bool get(StorageOf<Type::Num>&  value) const override { return false; }
-	bool get(StorageOf<Type::Str>&  value) const override { return false; }
-
-	void set(StorageOf<Type::Nil>        value) override { }
-	void set(StorageOf<Type::Bool>       value) override { }
-	void set(StorageOf<Type::Int>        value) override { }
-	void set(StorageOf<Type::Num>        value) override { }
-	void set(StorageOf<Type::Str> const& value) override { }
-	void set(StorageOf<Type::Str>&&      value) override { }
+	std::shared_ptr<Source> next(Reference const& ref) const override {
+		auto const curr = this->curr_();
+		if(curr == Dom::npos) {
+			return nullptr;
+		}
 
-	// clang-format on
+		auto const found = this->find_(curr, ref);
+		if(found == Dom::npos) {
+			return nullptr;
+		}
 
-	void assign(Reference const& ref, std::shared_ptr<Entry_> entry) override {
-		value = std::move(entry);
+		return std::make_shared<DomSource>(this->dom, found);
 	}
 
-	std::shared_ptr<Source> value;
-};
-
-class ScalarEntry: public Entry_ {
-   public:
-	ScalarEntry() = default;
-
-	ScalarEntry(ScalarStorage value)
-	    : value(std::move(value)) { }
-
-	std::shared_ptr<Source> next(Reference&& ref) override {
-		throw detail::InvalidAccessError();
-	}
+	void keys(std::function<bool(std::string const& key)> const& functor) const override {
+		auto const curr = this->curr_();
+		if(curr == Dom::npos) {
+			return;
+		}
 
-	std::shared_ptr<Source> next(Reference const& ref) override {
-		throw detail::InvalidAccessError();
+		this->keys_(curr, functor);
 	}
 
-	std::shared_ptr<Source> next(Reference const& ref) const override {
-		throw detail::InvalidAccessError();
-	}
+	void entries(detail::FunctionRef<bool(std::string const& key, std::shared_ptr<Source> const& next)> functor) const override {
+		auto const curr = this->curr_();
+		if(curr == Dom::npos || !this->dom->is(curr, Type::Map)) {
+			return;
+		}
 
-	void keys(std::function<bool(std::string const& key)> const& functor) const override {
+		std::size_t const size = this->dom->size(curr);
+		for(std::size_t i = 0; i < size; ++i) {
+			std::shared_ptr<Source> const next = std::make_shared<DomSource>(this->dom, this->dom->at(curr, i));
+			if(!functor(this->dom->symbolAt(curr, i).str(), next)) {
+				return;
+			}
+		}
 	}
 
 	std::size_t size() const override {
-		return 0;
+		auto const curr = this->curr_();
+		if(curr == Dom::npos) {
+			return 0;
+		}
+
+		return this->dom->size(curr);
 	}
 
 	bool has(Reference const& ref) const override {
-		return false;
+		auto const curr = this->curr_();
+		if(curr == Dom::npos) {
+			return false;
+		}
+
+		return this->find_(curr, ref) != Dom::npos;
 	}
 
 	bool is(Type type) const override {
-		switch(type) {
-		case Type::Nil: return std::holds_alternative<StorageOf<Type::Nil>>(this->value);
-		case Type::Bool: return std::holds_alternative<StorageOf<Type::Bool>>(this->value);
-		case Type::Int: return std::holds_alternative<StorageOf<Type::Int>>(this->value);
-		case Type::Num: return std::holds_alternative<StorageOf<Type::Num>>(this->value);
-		case Type::Str: return std::holds_alternative<StorageOf<Type::Str>>(this->value);
-
-		default: return false;
+		auto const curr = this->curr_();
+		if(curr == Dom::npos || type == Type::Unspecified) {
+			return false;
 		}
+
+		return this->dom->is(curr, type);
 	}
 
 	// clang-format off
-	bool get(StorageOf<Type::Nil>   value) const { return this->get_(value); }
-	bool get(StorageOf<Type::Bool>& value) const { return this->get_(value); }
-	bool get(StorageOf<Type::Int>&  value) const { return this->get_(value); }
-	bool get(StorageOf<Type::Num>&  value) const { return this->get_(value); }
-	bool get(StorageOf<Type::Str>&  value) const { return this->get_(value); }
-
-	void set(StorageOf<Type::Nil>        value) { this->value = value; }
-	void set(StorageOf<Type::Bool>       value) { this->value = value; }
-	void set(StorageOf<Type::Int>        value) { this->value = value; }
-	void set(StorageOf<Type::Num>        value) { this->value = value; }
-	void set(StorageOf<Type::Str> const& value) { this->value = value; }
-	void set(StorageOf<Type::Str>&&      value) { this->value = value; }
-
+	bool get(StorageOf<Type::Nil>   value) const override { return this->get_(this->curr_(), value); }
+	bool get(StorageOf<Type::Bool>& value) const override { return this->get_(this->curr_(), value); }
+	bool get(StorageOf<Type::Int>&  value) const override { return this->get_(this->curr_(), value); }
+	bool get(StorageOf<Type::Num>&  value) const override { return this->get_(this->curr_(), value); }
+	bool get(StorageOf<Type::Str>&  value) const override { return this->get_(this->curr_(), value); }
+
+	void set(StorageOf<Type::Nil>        value) override { this->dom->set(this->resolve_(), value); }
+	void set(StorageOf<Type::Bool>       value) override { this->dom->set(this->resolve_(), value); }
+	void set(StorageOf<Type::Int>        value) override { this->dom->set(this->resolve_(), value); }
+	void set(StorageOf<Type::Num>        value) override { this->dom->set(this->resolve_(), value); }
+	void set(StorageOf<Type::Str> const& value) override { this->dom->set(this->resolve_(), value); }
+	void set(StorageOf<Type::Str>&&      value) override { this->dom->set(this->resolve_(), value); }
 	// clang-format on
 
-	void assign(Reference const& ref, std::shared_ptr<Entry_> entry) override {
-		throw detail::InvalidAccessError();
+	std::shared_ptr<Dom> dom;
+
+	Dom::Index index  = Dom::npos;
+	Dom::Index parent = Dom::npos;
+	Reference  ref;
+
+   protected:
+	// Handles are node indices; `Dom::npos` refers to a node that does not exist.
+
+	Handle handle_() const override {
+		return this->curr_();
 	}
 
-	ScalarStorage value;
+	Cursor nextAt_(Handle handle, Reference const& ref) const override {
+		if(handle == Dom::npos) {
+			return Cursor();
+		}
 
-   private:
-	template<typename T>
-	bool get_(T& value) const {
-		auto const* v = std::get_if<T>(&this->value);
-		if(v == nullptr) {
-			return false;
+		auto const found = this->find_(static_cast<Dom::Index>(handle), ref);
+		if(found == Dom::npos) {
+			return Cursor();
 		}
 
-		value = *v;
-		return true;
+		return Cursor(*this, found);
 	}
-};
-
-class MapEntry: public Entry_ {
-   public:
-	MapEntry() = default;
 
-	MapEntry(std::initializer_list<std::pair<std::string, Source::Entry>> values) {
-		for(auto& value: values) {
-			auto entry = std::dynamic_pointer_cast<Entry_>(std::move(value.second.source));
-			assert(entry != nullptr);
+	Cursor nextAt_(Handle handle, Reference const& ref, std::size_t& hint) const override {
+		if(handle == Dom::npos || ref.isIndex()) {
+			return this->nextAt_(handle, ref);
+		}
 
-			this->values.insert_or_assign(std::move(value.first), std::move(entry));
+		auto const found = this->dom->find(static_cast<Dom::Index>(handle), ref.symbol(), hint);
+		if(found == Dom::npos) {
+			return Cursor();
 		}
-	}
 
-	std::shared_ptr<Source> next(Reference&& ref) override {
-		return this->values[std::move(ref).key()];
+		return Cursor(*this, found);
 	}
 
-	std::shared_ptr<Source> next(Reference const& ref) override {
-		return this->values[ref.key()];
+	void keysAt_(Handle handle, std::function<bool(std::string const& key)> const& functor) const override {
+		if(handle == Dom::npos) {
+			return;
+		}
+
+		this->keys_(static_cast<Dom::Index>(handle), functor);
 	}
 
-	std::shared_ptr<Source> next(Reference const& ref) const override {
-		auto const it = this->values.find(ref.key());
-		if(it == this->values.cend()) {
-			return nullptr;
+	void entriesAt_(Handle handle, detail::FunctionRef<bool(std::string const& key, Cursor const& next)> functor) const override {
+		if(handle == Dom::npos) {
+			return;
 		}
 
-		return this->values.at(ref.key());
-	}
+		auto const curr = static_cast<Dom::Index>(handle);
+		if(!this->dom->is(curr, Type::Map)) {
+			return;
+		}
 
-	void keys(std::function<bool(std::string const& key)> const& functor) const override {
-		for(auto const& [key, _]: this->values) {
-			if(!functor(key)) {
+		std::size_t const size = this->dom->size(curr);
+		for(std::size_t i = 0; i < size; ++i) {
+			if(!functor(this->dom->symbolAt(curr, i).str(), Cursor(*this, this->dom->at(curr, i)))) {
 				return;
 			}
 		}
 	}
 
-	std::size_t size() const override {
-		return this->values.size();
+	std::size_t sizeAt_(Handle handle) const override {
+		if(handle == Dom::npos) {
+			return 0;
+		}
+
+		return this->dom->size(static_cast<Dom::Index>(handle));
 	}
 
-	bool has(Reference const& ref) const override {
-		if(ref.isIndex()) {
+	bool hasAt_(Handle handle, Reference const& ref) const override {
+		if(handle == Dom::npos) {
 			return false;
 		}
 
-		auto const it = this->values.find(ref.key());
-		return it != this->values.cend();
+		return this->find_(static_cast<Dom::Index>(handle), ref) != Dom::npos;
 	}
 
-	bool is(Type type) const override {
-		return type == Type::Map;
-	}
+	bool isAt_(Handle handle, Type type) const override {
+		if(handle == Dom::npos || type == Type::Unspecified) {
+			return false;
+		}
 
-	// clang-format off
-	bool get(StorageOf<Type::Nil>   value) const override { return false; }
-	bool get(StorageOf<Type::Bool>& value) const override { return false; }
-	bool get(StorageOf<Type::Int>&  value) const override { return false; }
-	bool get(StorageOf<Type::Num>&  value) const override { return false; }
-	bool get(StorageOf<Type::Str>&  value) const override { return false; }
-
-	void set(StorageOf<Type::Nil>        value) override { }
-	void set(StorageOf<Type::Bool>       value) override { }
-	void set(StorageOf<Type::Int>        value) override { }
-	void set(StorageOf<Type::Num>        value) override { }
-	void set(StorageOf<Type::Str> const& value) override { }
-	void set(StorageOf<Type::Str>&&      value) override { }
+		return this->dom->is(static_cast<Dom::Index>(handle), type);
+	}
 
-	// clang-format on
+	void const* addressAt_(Handle handle) const override {
+		if(handle == Dom::npos) {
+			return nullptr;
+		}
 
-	void assign(Reference const& ref, std::shared_ptr<Entry_> entry) override {
-		this->values[ref.key()] = std::move(entry);
+		return &this->dom->node(static_cast<Dom::Index>(handle));
 	}
 
-	detail::OrderedMap<std::string, std::shared_ptr<Entry_>> values;
-};
-
-class ListEntry: public Entry_ {
-   public:
-	ListEntry() = default;
+	// clang-format off
+	bool getAt_(Handle handle, StorageOf<Type::Nil>   value) const override { return this->get_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Bool>& value) const override { return this->get_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Int>&  value) const override { return this->get_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Num>&  value) const override { return this->get_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Str>&  value) const override { return this->get_(handle, value); }
+
+	bool getAt_(Handle handle, std::span<StorageOf<Type::Int>> values) const override { return this->get_(handle, values); }
+	bool getAt_(Handle handle, std::span<StorageOf<Type::Num>> values) const override { return this->get_(handle, values); }
+	// clang-format on
 
-	ListEntry(std::initializer_list<Source::Entry> values) {
-		this->values.reserve(values.size());
-		for(auto& value: values) {
-			auto entry = std::dynamic_pointer_cast<Entry_>(std::move(value.source));
-			assert(entry != nullptr);
+   private:
+	Dom::Index find_(Dom::Index curr, Reference const& ref) const {
+		if(ref.isIndex()) {
+			if(!this->dom->is(curr, Type::List)) {
+				return Dom::npos;
+			}
 
-			this->values.emplace_back(std::move(entry));
+			return this->dom->at(curr, ref.index());
+		} else {
+			return this->dom->find(curr, ref.symbol());
 		}
 	}
 
-	std::shared_ptr<Source> next(Reference&& ref) override {
-		return this->next(ref);
-	}
-
-	std::shared_ptr<Source> next(Reference const& ref) override {
-		auto const index = ref.index();
-
-		if(index >= this->values.size()) {
-			this->values.resize(index);
+	Dom::Index curr_() const {
+		if(this->index != Dom::npos) {
+			return this->index;
 		}
 
-		return this->values[index];
+		return this->find_(this->parent, this->ref);
 	}
 
-	std::shared_ptr<Source> next(Reference const& ref) const override {
-		auto const index = ref.index();
-		if(index >= this->values.size()) {
-			return nullptr;
+	/**
+	 * @brief Creates the node if it does not exist yet.
+	 */
+	Dom::Index resolve_() {
+		if(this->index != Dom::npos) {
+			return this->index;
 		}
 
-		return this->values.at(index);
-	}
-
-	void keys(std::function<bool(std::string const& key)> const& functor) const override {
-	}
+		if(this->ref.isIndex()) {
+			if(!this->dom->is(this->parent, Type::List)) {
+				this->dom->reset(this->parent, Type::List);
+			}
 
-	std::size_t size() const override {
-		return this->values.size();
-	}
+			this->index = this->dom->child(this->parent, this->ref.index());
+		} else {
+			if(!this->dom->is(this->parent, Type::Map)) {
+				this->dom->reset(this->parent, Type::Map);
+			}
 
-	bool has(Reference const& ref) const override {
-		if(!ref.isIndex()) {
-			return false;
+			this->index = this->dom->child(this->parent, this->ref.symbol());
 		}
 
-		auto const index = ref.index();
-		return this->values.size() > index;
+		return this->index;
 	}
 
-	bool is(Type type) const override {
-		return type == Type::List;
-	}
+	/**
+	 * @brief Creates the node if it does not exist yet and turns it into a container of \a type
+	 * if it is not.
+	 */
+	Dom::Index resolve_(Type type) {
+		auto const curr = this->resolve_();
+		if(!this->dom->is(curr, type)) {
+			this->dom->reset(curr, type);
+		}
 
-	// clang-format off
-	bool get(StorageOf<Type::Nil>   value) const override { return false; }
-	bool get(StorageOf<Type::Bool>& value) const override { return false; }
-	bool get(StorageOf<Type::Int>&  value) const override { return false; }
-	bool get(StorageOf<Type::Num>&  value) const override { return false; }
-	bool get(StorageOf<Type::Str>&  value) const override { return false; }
-
-	void set(StorageOf<Type::Nil>        value) override { }
-	void set(StorageOf<Type::Bool>       value) override { }
-	void set(StorageOf<Type::Int>        value) override { }
-	void set(StorageOf<Type::Num>        value) override { }
-	void set(StorageOf<Type::Str> const& value) override { }
-	void set(StorageOf<Type::Str>&&      value) override { }
+		return curr;
+	}
 
-	// clang-format on
+	void keys_(Dom::Index curr, std::function<bool(std::string const& key)> const& functor) const {
+		if(!this->dom->is(curr, Type::Map)) {
+			return;
+		}
 
-	void assign(Reference const& ref, std::shared_ptr<Entry_> entry) override {
-		auto const index = ref.index();
+		std::size_t const size = this->dom->size(curr);
+		for(std::size_t i = 0; i < size; ++i) {
+			if(!functor(this->dom->symbolAt(curr, i).str())) {
+				return;
+			}
+		}
+	}
 
-		if(index >= this->values.size()) {
-			this->values.resize(index + 1);
+	template<typename V>
+	bool get_(Handle handle, V& value) const {
+		if(handle == Dom::npos) {
+			return false;
 		}
 
-		this->values[index] = std::move(entry);
+		return this->dom->get(static_cast<Dom::Index>(handle), value);
 	}
-
-	std::vector<std::shared_ptr<Entry_>> values;
 };
 
-class Accessor: public Source {
+/**
+ * @brief Source of an Entry, built into a Dom the first time it is accessed.
+ *
+ * A container refers to the Sources of its children instead of copying them, so the Entries
+ * nested in a literal are never built themselves; the outermost one builds the whole literal
+ * into a single Dom at once.
+ */
+class EntrySource: public Source {
    public:
-	Accessor(std::shared_ptr<Entry_> prev, Reference const& ref)
-	    : prev(std::move(prev))
-	    , ref(ref) { }
+	using Value = std::variant<
+	    StorageOf<Type::Nil>,
+	    StorageOf<Type::Bool>,
+	    StorageOf<Type::Int>,
+	    StorageOf<Type::Num>,
+	    StorageOf<Type::Str>>;
 
-	Accessor(std::shared_ptr<Entry_> prev, Reference&& ref)
-	    : prev(std::move(prev))
-	    , ref(std::move(ref)) { }
+	using Children = std::vector<std::pair<Symbol, std::shared_ptr<EntrySource const>>>;
+
+	EntrySource(Value value)
+	    : value_(std::move(value)) { }
+
+	EntrySource(Type type, Children children)
+	    : type_(type)
+	    , children_(std::move(children)) { }
 
 	std::shared_ptr<Source> next(Reference&& ref) override {
-		auto curr = ref.isIndex() ? this->resolve_<ListEntry>() : this->resolve_<MapEntry>();
-		return std::make_shared<Accessor>(std::move(curr), std::move(ref));
+		return this->built().next(std::move(ref));
 	}
 
 	std::shared_ptr<Source> next(Reference const& ref) override {
-		auto curr = ref.isIndex() ? this->resolve_<ListEntry>() : this->resolve_<MapEntry>();
-		return std::make_shared<Accessor>(std::move(curr), ref);
+		return this->built().next(ref);
 	}
 
 	std::shared_ptr<Source> next(Reference const& ref) const override {
-		auto curr = this->curr_();
-		if(curr == nullptr) {
-			return nullptr;
-		}
-
-		if(!curr->has(ref)) {
-			return nullptr;
-		}
-
-		return std::make_shared<Accessor>(std::move(curr), ref);
+		return std::as_const(this->built()).next(ref);
 	}
 
 	void keys(std::function<bool(std::string const& key)> const& functor) const override {
-		auto const curr = this->curr_();
-		curr->keys(functor);
+		this->built().keys(functor);
 	}
 
-	std::size_t size() const override {
-		auto const curr = this->curr_();
-		if(curr == nullptr) {
-			return 0;
-		}
-
-		return curr->size();
+	void entries(detail::FunctionRef<bool(std::string const& key, std::shared_ptr<Source> const& next)> functor) const override {
+		this->built().entries(functor);
 	}
 
-	bool has(Reference const& ref) const override {
-		auto const curr = this->curr_();
-		if(curr == nullptr) {
-			return false;
-		}
+	// clang-format off
+	std::size_t size()                   const override { return this->built().size(); }
+	bool        has(Reference const& ref) const override { return this->built().has(ref); }
+	bool        is(Type type)            const override { return this->built().is(type); }
+
+	bool get(StorageOf<Type::Nil>   value) const override { return this->built().get(value); }
+	bool get(StorageOf<Type::Bool>& value) const override { return this->built().get(value); }
+	bool get(StorageOf<Type::Int>&  value) const override { return this->built().get(value); }
+	bool get(StorageOf<Type::Num>&  value) const override { return this->built().get(value); }
+	bool get(StorageOf<Type::Str>&  value) const override { return this->built().get(value); }
+
+	void set(StorageOf<Type::Nil>        value) override { this->built().set(value); }
+	void set(StorageOf<Type::Bool>       value) override { this->built().set(value); }
+	void set(StorageOf<Type::Int>        value) override { this->built().set(value); }
+	void set(StorageOf<Type::Num>        value) override { this->built().set(value); }
+	void set(StorageOf<Type::Str> const& value) override { this->built().set(value); }
+	void set(StorageOf<Type::Str>&&      value) override { this->built().set(std::move(value)); }
+	// clang-format on
 
-		return curr->has(ref);
-	}
+	/**
+	 * @brief Source at the root of the Dom the Entry is built into.
+	 */
+	DomSource& built() const {
+		std::call_once(this->once_, [this] {
+			auto       dom  = std::make_shared<Dom>();
+			auto const root = dom->root();
+			this->build_(*dom, root);
 
-	bool is(Type type) const override {
-		auto const curr = this->curr_();
-		if(curr == nullptr) {
-			return false;
-		}
+			this->built_ = std::make_shared<DomSource>(std::move(dom), root);
+		});
+
+		return *this->built_;
+	}
 
-		return curr->is(type);
+	std::shared_ptr<DomSource> const& builtPtr() const {
+		this->built();
+		return this->built_;
 	}
 
+   protected:
+	// Handles are the ones of the built Source.
+
 	// clang-format off
-	bool get(StorageOf<Type::Nil>   value) const override { return this->get_(value); }
-	bool get(StorageOf<Type::Bool>& value) const override { return this->get_(value); }
-	bool get(StorageOf<Type::Int>&  value) const override { return this->get_(value); }
-	bool get(StorageOf<Type::Num>&  value) const override { return this->get_(value); }
-	bool get(StorageOf<Type::Str>&  value) const override { return this->get_(value); }
-
-	void set(StorageOf<Type::Nil>        value) override { this->set_(value); }
-	void set(StorageOf<Type::Bool>       value) override { this->set_(value); }
-	void set(StorageOf<Type::Int>        value) override { this->set_(value); }
-	void set(StorageOf<Type::Num>        value) override { this->set_(value); }
-	void set(StorageOf<Type::Str> const& value) override { this->set_(value); }
-	void set(StorageOf<Type::Str>&&      value) override { this->set_(std::move(value)); }
+	Handle handle_() const override { return this->built().handle_(); }
 
-	// clang-format on
+	Cursor nextAt_(Handle handle, Reference const& ref)                    const override { return this->built().nextAt_(handle, ref); }
+	Cursor nextAt_(Handle handle, Reference const& ref, std::size_t& hint) const override { return this->built().nextAt_(handle, ref, hint); }
 
-	std::shared_ptr<Entry_> prev;
-	Reference const         ref;
+	void keysAt_(Handle handle, std::function<bool(std::string const& key)> const& functor)                   const override { this->built().keysAt_(handle, functor); }
+	void entriesAt_(Handle handle, detail::FunctionRef<bool(std::string const& key, Cursor const& next)> functor) const override { this->built().entriesAt_(handle, functor); }
 
-   private:
-	std::shared_ptr<Entry_> curr_() const {
-		auto prev = std::as_const(*this->prev).next(this->ref);
-		return std::dynamic_pointer_cast<Entry_>(prev);
-	}
+	std::size_t sizeAt_(Handle handle)                       const override { return this->built().sizeAt_(handle); }
+	bool        hasAt_(Handle handle, Reference const& ref)  const override { return this->built().hasAt_(handle, ref); }
+	bool        isAt_(Handle handle, Type type)              const override { return this->built().isAt_(handle, type); }
+	void const* addressAt_(Handle handle)                    const override { return this->built().addressAt_(handle); }
 
-	template<std::derived_from<Entry_> T>
-	std::shared_ptr<Entry_> resolve_() const {
-		auto curr = this->curr_();
-		if(dynamic_cast<T*>(curr.get()) == nullptr) {
-			return nullptr;
-		}
+	bool getAt_(Handle handle, StorageOf<Type::Nil>   value) const override { return this->built().getAt_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Bool>& value) const override { return this->built().getAt_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Int>&  value) const override { return this->built().getAt_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Num>&  value) const override { return this->built().getAt_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Str>&  value) const override { return this->built().getAt_(handle, value); }
 
-		return curr;
-	}
+	bool getAt_(Handle handle, std::span<StorageOf<Type::Int>> values) const override { return this->built().getAt_(handle, values); }
+	bool getAt_(Handle handle, std::span<StorageOf<Type::Num>> values) const override { return this->built().getAt_(handle, values); }
+	// clang-format on
 
-	template<std::derived_from<Entry_> T>
-	std::shared_ptr<Entry_> resolve_() {
-		auto curr = this->curr_();
-		if(dynamic_cast<T*>(curr.get()) == nullptr) {
-			curr = std::make_shared<T>();
-			this->prev->assign(this->ref, curr);
+   private:
+	void build_(Dom& dom, Dom::Index index) const {
+		if(this->built_ != nullptr) {
+			// Accessed, and possibly written, before it was nested.
+			dom.graft(index, *this->built_->dom, this->built_->index);
+			return;
 		}
 
-		return curr;
-	}
+		switch(this->type_) {
+		case Type::Map: {
+			dom.reset(index, Type::Map);
+			dom.reserve(index, this->children_.size());
+			for(auto const& [key, next]: this->children_) {
+				next->build_(dom, dom.child(index, key));
+			}
+			return;
+		}
 
-	template<typename V>
-	bool get_(V& value) const {
-		auto const curr = this->resolve_<ScalarEntry>();
-		if(curr == nullptr) {
-			return false;
+		case Type::List: {
+			dom.reset(index, Type::List);
+			dom.reserve(index, this->children_.size());
+			for(auto const& [key, next]: this->children_) {
+				next->build_(dom, dom.append(index));
+			}
+			return;
 		}
-		return curr->get(value);
-	}
 
-	template<typename V>
-	bool get_(V& value) {
-		auto const curr = this->resolve_<ScalarEntry>();
-		return curr->get(value);
+		default: {
+			std::visit([&](auto const& value) { dom.set(index, value); }, this->value_);
+			return;
+		}
+		}
 	}
 
-	template<typename V>
-	void set_(V const& value) {
-		auto const curr = this->resolve_<ScalarEntry>();
-		return curr->set(value);
-	}
+	// Type of a container; `Type::Unspecified` for a scalar, which is held in `value_`.
+	Type     type_ = Type::Unspecified;
+	Value    value_;
+	Children children_;
+
+	mutable std::once_flag             once_;
+	mutable std::shared_ptr<DomSource> built_;
 };
 
+EntrySource const& entryOf(Source::Entry const& entry) {
+	auto const* source = dynamic_cast<EntrySource const*>(entry.source.get());
+	assert(source != nullptr);
+
+	return *source;
+}
+
 }  // namespace
 
 // clang-format off
-Source::Entry::Entry(StorageOf<Type::Nil>  value) : source(std::make_shared<ScalarEntry>(value)) { }
-Source::Entry::Entry(StorageOf<Type::Bool> value) : source(std::make_shared<ScalarEntry>(value)) { }
-Source::Entry::Entry(StorageOf<Type::Int>  value) : source(std::make_shared<ScalarEntry>(value)) { }
-Source::Entry::Entry(StorageOf<Type::Num>  value) : source(std::make_shared<ScalarEntry>(value)) { }
-Source::Entry::Entry(StorageOf<Type::Str>  value) : source(std::make_shared<ScalarEntry>(value)) { }
-
-Source::Entry::Entry(std::initializer_list<Entry>        values) : source(std::make_shared<ListEntry>(values)) { }
-Source::Entry::Entry(std::initializer_list<MapValueType> values) : source(std::make_shared<MapEntry>(values)) { }
+Source::Entry::Entry(StorageOf<Type::Nil>  value) : source(std::make_shared<EntrySource>(value)) { }
+Source::Entry::Entry(StorageOf<Type::Bool> value) : source(std::make_shared<EntrySource>(value)) { }
+Source::Entry::Entry(StorageOf<Type::Int>  value) : source(std::make_shared<EntrySource>(value)) { }
+Source::Entry::Entry(StorageOf<Type::Num>  value) : source(std::make_shared<EntrySource>(value)) { }
+Source::Entry::Entry(StorageOf<Type::Str>  value) : source(std::make_shared<EntrySource>(std::move(value))) { }
 
 Source::Entry::Entry(int         value) : Entry(static_cast<StorageOf<Type::Int>>(value)) { }
 Source::Entry::Entry(char const* value) : Entry(StorageOf<Type::Str>(value)) { }
 
 // clang-format on
 
+Source::Entry::Entry(std::initializer_list<Entry> values) {
+	EntrySource::Children children;
+	children.reserve(values.size());
+	for(auto const& value: values) {
+		children.emplace_back(Symbol(), std::static_pointer_cast<EntrySource const>(value.source));
+	}
+
+	this->source = std::make_shared<EntrySource>(Type::List, std::move(children));
+}
+
+Source::Entry::Entry(std::initializer_list<MapValueType> values) {
+	EntrySource::Children children;
+	children.reserve(values.size());
+	for(auto const& [key, value]: values) {
+		children.emplace_back(Symbol(key), std::static_pointer_cast<EntrySource const>(value.source));
+	}
+
+	this->source = std::make_shared<EntrySource>(Type::Map, std::move(children));
+}
+
 std::shared_ptr<Source> Source::make(Source::Entry value) {
-	auto entry = std::dynamic_pointer_cast<Entry_>(std::move(value.source));
-	assert(entry != nullptr);
+	return entryOf(value).builtPtr();
+}
+
+std::shared_ptr<Source> Source::fromDom(std::shared_ptr<Dom> dom) {
+	assert(dom != nullptr);
 
-	return std::make_shared<Accessor>(std::make_shared<RootEntry>(std::move(entry)), Reference());
+	auto const root = dom->root();
+	return std::make_shared<DomSource>(std::move(dom), root);
 }
 
 }  // namespace cray
@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "cray/source.hpp"
+#include "cray/symbol.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+namespace {
+
+/**
+ * @brief Node at the same path in every layer.
+ *
+ * Which layers take part is resolved on first access and cached until a write through any node
+ * of the overlay. The topmost layer that has the node wins. If it is a container, it is merged
+ * with the containers of the same type right below it, maps by key and lists by index, up to the
+ * first layer whose node is of another type; that layer and the ones under it are hidden.
+ *
+ * Children are cached in their parent and owned by the tree, so navigating to the same node again
+ * does not resolve the layers or allocate anew. The Sources handed out share the ownership of the
+ * root.
+ */
+class OverlaySource
+    : public Source
+    , public std::enable_shared_from_this<OverlaySource> {
+   public:
+	/**
+	 * @param layers Root of each layer ordered from the bottom to the top.
+	 */
+	OverlaySource(std::vector<std::shared_ptr<Source>> layers)
+	    : root(this)
+	    , layers_(std::move(layers)) { }
+
+	/**
+	 * @brief Construct the node at \a ref in \a parent. Its layers are resolved through the
+	 * parent on first access, and the node is created in the top layer through the parent on
+	 * write.
+	 */
+	OverlaySource(OverlaySource* parent, Reference ref)
+	    : parent(parent)
+	    , root(parent->root)
+	    , ref(std::move(ref))
+	    , layers_(parent->layers_.size()) { }
+
+	std::shared_ptr<Source> next(Reference&& ref) override {
+		return this->next(std::as_const(ref));
+	}
+
+	std::shared_ptr<Source> next(Reference const& ref) override {
+		// Turns the node into a container in the top layer as the other Sources do.
+		auto top = this->top_()->next(ref);
+
+		auto& next = this->cached_(ref);
+		if(next == nullptr) {
+			next = std::make_unique<OverlaySource>(this, ref);
+		}
+
+		// Kept for the same reason as in `top_()`.
+		next->resolve_();
+		next->layers_.back() = std::move(top);
+		next->resolved_      = false;
+
+		return this->share_(next.get());
+	}
+
+	std::shared_ptr<Source> next(Reference const& ref) const override {
+		auto* const next = this->child_(ref);
+		if(next == nullptr) {
+			return nullptr;
+		}
+
+		return this->share_(next);
+	}
+
+	void keys(std::function<bool(std::string const& key)> const& functor) const override {
+		auto const& merged = this->resolve_();
+		if(this->type_ != Type::Map) {
+			return;
+		}
+
+		if(merged.size() == 1) {
+			this->layers_[merged.front()]->keys(functor);
+			return;
+		}
+
+		// Keys of lower layers come first so that an override keeps the order of the defaults.
+		std::unordered_set<Symbol> visited;
+
+		bool stop = false;
+		for(auto it = merged.rbegin(); it != merged.rend() && !stop; ++it) {
+			this->layers_[*it]->keys([&](std::string const& key) {
+				if(!visited.insert(Symbol(key)).second) {
+					return true;
+				}
+
+				stop = !functor(key);
+				return !stop;
+			});
+		}
+	}
+
+	std::size_t size() const override {
+		auto const& merged = this->resolve_();
+		if(this->size_.has_value()) {
+			return *this->size_;
+		}
+
+		std::size_t size = 0;
+		switch(this->type_) {
+		case Type::Map: {
+			if(merged.size() == 1) {
+				size = this->layers_[merged.front()]->size();
+				break;
+			}
+
+			std::unordered_set<Symbol> visited;
+			for(auto const i: merged) {
+				this->layers_[i]->keys([&](std::string const& key) {
+					visited.insert(Symbol(key));
+					return true;
+				});
+			}
+
+			size = visited.size();
+			break;
+		}
+
+		case Type::List: {
+			for(auto const i: merged) {
+				size = std::max(size, this->layers_[i]->size());
+			}
+			break;
+		}
+
+		default:
+			break;
+		}
+
+		this->size_ = size;
+		return size;
+	}
+
+	bool has(Reference const& ref) const override {
+		for(auto const i: this->resolve_()) {
+			if(this->layers_[i]->has(ref)) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool is(Type type) const override {
+		this->resolve_();
+		return type != Type::Unspecified && this->type_ == type;
+	}
+
+	// clang-format off
+	bool get(StorageOf<Type::Nil>   value) const override { return this->get_(value); }
+	bool get(StorageOf<Type::Bool>& value) const override { return this->get_(value); }
+	bool get(StorageOf<Type::Int>&  value) const override { return this->get_(value); }
+	bool get(StorageOf<Type::Num>&  value) const override { return this->get_(value); }
+	bool get(StorageOf<Type::Str>&  value) const override { return this->get_(value); }
+
+	void set(StorageOf<Type::Nil>        value) override { this->top_()->set(value); }
+	void set(StorageOf<Type::Bool>       value) override { this->top_()->set(value); }
+	void set(StorageOf<Type::Int>        value) override { this->top_()->set(value); }
+	void set(StorageOf<Type::Num>        value) override { this->top_()->set(value); }
+	void set(StorageOf<Type::Str> const& value) override { this->top_()->set(value); }
+	void set(StorageOf<Type::Str>&&      value) override { this->top_()->set(std::move(value)); }
+	// clang-format on
+
+	// Overlay of the parent node; nullptr for the root.
+	OverlaySource* parent = nullptr;
+	OverlaySource* root;
+	Reference      ref;
+
+   private:
+	/**
+	 * @return Indices of the layers that take part in this node, from the top.
+	 */
+	std::vector<std::size_t> const& resolve_() const {
+		if(this->version_ != this->root->writes_) {
+			// Something was written since the layers were resolved; any of them may be gone.
+			this->version_  = this->root->writes_;
+			this->resolved_ = false;
+			if(this->parent != nullptr) {
+				this->relayer_();
+			}
+		}
+		if(this->resolved_) {
+			return this->merged_;
+		}
+
+		this->merged_.clear();
+		this->type_ = Type::Unspecified;
+		this->size_.reset();
+
+		for(std::size_t i = this->layers_.size(); i-- > 0;) {
+			if(this->layers_[i] == nullptr) {
+				continue;
+			}
+
+			auto const type = Source::Cursor(*this->layers_[i]).type();
+			if(type == Type::Unspecified) {
+				continue;
+			}
+
+			if(this->type_ == Type::Unspecified) {
+				this->type_ = type;
+			} else if(type != this->type_ || (type != Type::Map && type != Type::List)) {
+				break;
+			}
+
+			this->merged_.push_back(i);
+		}
+
+		this->resolved_ = true;
+		return this->merged_;
+	}
+
+	/**
+	 * @brief Resolves the node in each layer through the parent.
+	 */
+	void relayer_() const {
+		auto const& merged = this->parent->resolve_();
+		std::fill(this->layers_.begin(), this->layers_.end(), nullptr);
+
+		if(this->parent->type_ != Type::Map && this->parent->type_ != Type::List) {
+			return;
+		}
+		for(auto const i: merged) {
+			this->layers_[i] = std::as_const(*this->parent->layers_[i]).next(this->ref);
+		}
+	}
+
+	/**
+	 * @brief Node in the top layer, created through the parent if it does not exist yet.
+	 * Invalidates every node of the tree since the caller is about to write to it.
+	 */
+	std::shared_ptr<Source> const& top_() {
+		this->resolve_();
+		if(this->layers_.back() == nullptr) {
+			auto top = this->parent->top_()->next(this->ref);
+
+			// The node may not exist in the top layer until it is written, so it is kept after the
+			// other layers are resolved again.
+			this->resolve_();
+			this->layers_.back() = std::move(top);
+		}
+
+		// Layers of this node stay as they are; only its resolution changes with the write.
+		this->version_  = ++this->root->writes_;
+		this->resolved_ = false;
+		return this->layers_.back();
+	}
+
+	std::unique_ptr<OverlaySource>& cached_(Reference const& ref) const {
+		if(ref.isIndex()) {
+			return this->indices_[ref.index()];
+		} else {
+			return this->keys_[ref.symbol()];
+		}
+	}
+
+	OverlaySource* child_(Reference const& ref) const {
+		this->resolve_();
+		if(this->type_ != Type::Map && this->type_ != Type::List) {
+			return nullptr;
+		}
+
+		auto& next = this->cached_(ref);
+
+		bool const is_new = next == nullptr;
+		if(is_new) {
+			// Const navigation still yields a writable Source as the other Sources do.
+			next = std::make_unique<OverlaySource>(const_cast<OverlaySource*>(this), ref);
+		}
+
+		next->resolve_();
+		if(std::ranges::all_of(next->layers_, [](auto const& layer) { return layer == nullptr; })) {
+			// A node handed out before stays cached since it is still referred to.
+			if(is_new) {
+				next.reset();
+			}
+			return nullptr;
+		}
+
+		return next.get();
+	}
+
+	std::shared_ptr<Source> share_(OverlaySource* node) const {
+		return std::shared_ptr<Source>(this->root->shared_from_this(), node);
+	}
+
+	template<typename V>
+	bool get_(V& value) const {
+		auto const& merged = this->resolve_();
+		if(merged.empty()) {
+			return false;
+		}
+
+		return this->layers_[merged.front()]->get(value);
+	}
+
+	// Node in each layer ordered from the bottom to the top; nullptr if the layer does not have
+	// it.
+	mutable std::vector<std::shared_ptr<Source>> layers_;
+
+	// Number of writes through the tree; counted at the root.
+	std::size_t writes_ = 0;
+
+	// `writes_` of the root as of when the layers were last resolved.
+	mutable std::size_t version_ = static_cast<std::size_t>(-1);
+
+	mutable bool                       resolved_ = false;
+	mutable Type                       type_     = Type::Unspecified;
+	mutable std::vector<std::size_t>   merged_;
+	mutable std::optional<std::size_t> size_;
+
+	mutable std::unordered_map<Symbol, std::unique_ptr<OverlaySource>>      keys_;
+	mutable std::unordered_map<std::size_t, std::unique_ptr<OverlaySource>> indices_;
+};
+
+}  // namespace
+
+std::shared_ptr<Source> Source::overlay(std::vector<std::shared_ptr<Source>> layers) {
+	if(layers.empty()) {
+		throw std::invalid_argument("no layers to overlay");
+	}
+
+	for(auto const& layer: layers) {
+		if(layer == nullptr) {
+			throw std::invalid_argument("null layer");
+		}
+	}
+
+	return std::make_shared<OverlaySource>(std::move(layers));
+}
+
+}  // namespace cray
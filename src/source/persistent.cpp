@@ -0,0 +1,557 @@
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "cray/detail/function_ref.hpp"
+#include "cray/source.hpp"
+#include "cray/symbol.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+namespace {
+
+struct Node;
+
+using NodePtr = std::shared_ptr<Node const>;
+
+/**
+ * @brief Other readings of a string that reads as a scalar of another type as well, such as a
+ * plain YAML scalar.
+ */
+struct Plain {
+	std::optional<StorageOf<Type::Bool>> b;
+	std::optional<StorageOf<Type::Int>>  i;
+	std::optional<StorageOf<Type::Num>>  n;
+};
+
+/**
+ * @brief Immutable node of a persistent tree. A null NodePtr is a list element that was skipped
+ * over; children of a map are never null.
+ */
+struct Node {
+	using Map  = std::vector<std::pair<Symbol, NodePtr>>;
+	using List = std::vector<NodePtr>;
+
+	// Alternatives are in the order of `Type` so that the index maps to the type.
+	using Value = std::variant<
+	    StorageOf<Type::Nil>,
+	    StorageOf<Type::Bool>,
+	    StorageOf<Type::Int>,
+	    StorageOf<Type::Num>,
+	    StorageOf<Type::Str>,
+	    Map,
+	    List>;
+
+	inline Type type() const {
+		return static_cast<Type>(this->value.index() + 1);
+	}
+
+	/**
+	 * @return Value of type \a V the node reads as; the string itself is kept as it is and the
+	 * other readings are in `plain`.
+	 */
+	template<typename V>
+	V const* as() const {
+		if(auto const* v = std::get_if<V>(&this->value); v != nullptr) {
+			return v;
+		}
+		if(this->plain == nullptr) {
+			return nullptr;
+		}
+
+		std::optional<V> const* v = nullptr;
+		// clang-format off
+		if constexpr(std::is_same_v<V, StorageOf<Type::Bool>>) { v = &this->plain->b; }
+		if constexpr(std::is_same_v<V, StorageOf<Type::Int>>)  { v = &this->plain->i; }
+		if constexpr(std::is_same_v<V, StorageOf<Type::Num>>)  { v = &this->plain->n; }
+		// clang-format on
+
+		if(v == nullptr || !v->has_value()) {
+			return nullptr;
+		}
+
+		return &**v;
+	}
+
+	Value value;
+
+	// Set only for a string that reads as another scalar type as well.
+	std::unique_ptr<Plain const> plain = nullptr;
+};
+
+template<typename V>
+NodePtr makeNode(V&& value) {
+	return std::make_shared<Node const>(Node{.value = std::forward<V>(value)});
+}
+
+NodePtr const* findChild(Node const* node, Reference const& ref) {
+	if(node == nullptr) {
+		return nullptr;
+	}
+
+	if(ref.isIndex()) {
+		auto const* list = std::get_if<Node::List>(&node->value);
+		if(list == nullptr || ref.index() >= list->size()) {
+			return nullptr;
+		}
+
+		return &(*list)[ref.index()];
+	} else {
+		auto const* map = std::get_if<Node::Map>(&node->value);
+		if(map == nullptr) {
+			return nullptr;
+		}
+
+		auto const key = ref.symbol();
+		for(auto const& [k, v]: *map) {
+			if(k == key) {
+				return &v;
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+/**
+ * @brief Copy of \a node with the node at \a path replaced by `fn(node at path)`. Only the
+ * nodes on \a path are copied; the other children are shared with \a node.
+ *
+ * A node on the path that is not a container of the required type is replaced by an empty one,
+ * as writing through a Source does.
+ */
+NodePtr assign(NodePtr const& node, std::span<Reference const> path, detail::FunctionRef<NodePtr(NodePtr const& node)> fn) {
+	if(path.empty()) {
+		return fn(node);
+	}
+
+	auto const& ref  = path.front();
+	auto const  rest = path.subspan(1);
+
+	if(ref.isIndex()) {
+		Node::List list;
+		if(node != nullptr) {
+			if(auto const* l = std::get_if<Node::List>(&node->value); l != nullptr) {
+				list = *l;
+			}
+		}
+
+		if(ref.index() >= list.size()) {
+			list.resize(ref.index() + 1);
+		}
+
+		auto& next = list[ref.index()];
+		next       = assign(next, rest, fn);
+
+		return makeNode(std::move(list));
+	} else {
+		Node::Map map;
+		if(node != nullptr) {
+			if(auto const* m = std::get_if<Node::Map>(&node->value); m != nullptr) {
+				map = *m;
+			}
+		}
+
+		auto const key = ref.symbol();
+
+		auto it = map.begin();
+		for(; it != map.end(); ++it) {
+			if(it->first == key) {
+				break;
+			}
+		}
+		if(it == map.end()) {
+			map.emplace_back(key, nullptr);
+			it = std::prev(map.end());
+		}
+
+		it->second = assign(it->second, rest, fn);
+
+		return makeNode(std::move(map));
+	}
+}
+
+NodePtr copyOf(Source::Cursor const& src) {
+	if(!src) {
+		return nullptr;
+	}
+
+	if(src.is(Type::Map)) {
+		Node::Map map;
+		map.reserve(src.size());
+		src.entries([&](std::string const& key, Source::Cursor const& next) {
+			if(auto node = copyOf(next); node != nullptr) {
+				map.emplace_back(Symbol(key), std::move(node));
+			}
+			return true;
+		});
+
+		return makeNode(std::move(map));
+	}
+
+	if(src.is(Type::List)) {
+		std::size_t const size = src.size();
+
+		Node::List list;
+		list.reserve(size);
+		for(std::size_t i = 0; i < size; ++i) {
+			list.push_back(copyOf(src.next(i)));
+		}
+
+		return makeNode(std::move(list));
+	}
+
+	// A string is tried first so that the text of a plain scalar, such as `1.10` or `yes` in
+	// YAML, is kept along with the values it reads as.
+	if(StorageOf<Type::Str> v; src.get(v)) {
+		Plain plain;
+		// clang-format off
+		if(StorageOf<Type::Bool> u; src.get(u)) { plain.b = u; }
+		if(StorageOf<Type::Int>  u; src.get(u)) { plain.i = u; }
+		if(StorageOf<Type::Num>  u; src.get(u)) { plain.n = u; }
+		// clang-format on
+
+		Node node{.value = std::move(v)};
+		if(plain.b || plain.i || plain.n) {
+			node.plain = std::make_unique<Plain const>(plain);
+		}
+
+		return std::make_shared<Node const>(std::move(node));
+	}
+
+	// clang-format off
+	if(StorageOf<Type::Bool> v; src.get(v)) { return makeNode(v); }
+	if(StorageOf<Type::Int>  v; src.get(v)) { return makeNode(v); }
+	if(StorageOf<Type::Num>  v; src.get(v)) { return makeNode(v); }
+	if(src.get(nullptr)) { return makeNode(nullptr); }
+	// clang-format on
+
+	return nullptr;
+}
+
+/**
+ * @brief Version of the document shared by Sources navigated from the same root. A write
+ * replaces the root with a new one.
+ */
+struct Tree {
+	NodePtr root;
+};
+
+class PersistentSource: public Source {
+   public:
+	PersistentSource(std::shared_ptr<Tree> tree, std::vector<Reference> path = {})
+	    : tree(std::move(tree))
+	    , path(std::move(path)) { }
+
+	std::shared_ptr<Source> next(Reference&& ref) override {
+		return this->next(std::as_const(ref));
+	}
+
+	std::shared_ptr<Source> next(Reference const& ref) override {
+		auto const type = ref.isIndex() ? Type::List : Type::Map;
+
+		auto const* curr = this->curr_().get();
+		if(curr == nullptr || curr->type() != type) {
+			this->assign_([&](NodePtr const& node) {
+				if(type == Type::List) {
+					return makeNode(Node::List());
+				} else {
+					return makeNode(Node::Map());
+				}
+			});
+		}
+
+		return this->child_(ref);
+	}
+
+	std::shared_ptr<Source> next(Reference const& ref) const override {
+		auto const* next = findChild(this->curr_().get(), ref);
+		if(next == nullptr || *next == nullptr) {
+			return nullptr;
+		}
+
+		return this->child_(ref);
+	}
+
+	void keys(std::function<bool(std::string const& key)> const& functor) const override {
+		this->keysAt_(this->handle_(), functor);
+	}
+
+	void entries(detail::FunctionRef<bool(std::string const& key, std::shared_ptr<Source> const& next)> functor) const override {
+		auto const* map = std::get_if<Node::Map>(&nodeOf_(this->handle_())->value);
+		if(map == nullptr) {
+			return;
+		}
+
+		for(auto const& [key, next]: *map) {
+			std::shared_ptr<Source> const src = this->child_(key);
+			if(!functor(key.str(), src)) {
+				return;
+			}
+		}
+	}
+
+	std::size_t size() const override {
+		return this->sizeAt_(this->handle_());
+	}
+
+	bool has(Reference const& ref) const override {
+		return this->hasAt_(this->handle_(), ref);
+	}
+
+	bool is(Type type) const override {
+		return this->isAt_(this->handle_(), type);
+	}
+
+	// clang-format off
+	bool get(StorageOf<Type::Nil>   value) const override { return this->get_(this->handle_(), value); }
+	bool get(StorageOf<Type::Bool>& value) const override { return this->get_(this->handle_(), value); }
+	bool get(StorageOf<Type::Int>&  value) const override { return this->get_(this->handle_(), value); }
+	bool get(StorageOf<Type::Num>&  value) const override { return this->get_(this->handle_(), value); }
+	bool get(StorageOf<Type::Str>&  value) const override { return this->get_(this->handle_(), value); }
+
+	void set(StorageOf<Type::Nil>        value) override { this->set_(value); }
+	void set(StorageOf<Type::Bool>       value) override { this->set_(value); }
+	void set(StorageOf<Type::Int>        value) override { this->set_(value); }
+	void set(StorageOf<Type::Num>        value) override { this->set_(value); }
+	void set(StorageOf<Type::Str> const& value) override { this->set_(value); }
+	void set(StorageOf<Type::Str>&&      value) override { this->set_(std::move(value)); }
+	// clang-format on
+
+	std::shared_ptr<Source> snapshot() const override {
+		return std::make_shared<PersistentSource>(std::make_shared<Tree>(Tree{.root = this->curr_()}));
+	}
+
+	std::shared_ptr<Tree> tree;
+
+	// Path from the root of the tree, resolved again whenever the tree gets a new root.
+	std::vector<Reference> path;
+
+   protected:
+	// Handles are addresses of nodes; 0 refers to a node that does not exist. They stay valid
+	// until the next write through any Source sharing the tree.
+
+	Handle handle_() const override {
+		return reinterpret_cast<Handle>(this->curr_().get());
+	}
+
+	Cursor nextAt_(Handle handle, Reference const& ref) const override {
+		auto const* next = findChild(nodeOf_(handle), ref);
+		if(next == nullptr || *next == nullptr) {
+			return Cursor();
+		}
+
+		return Cursor(*this, reinterpret_cast<Handle>(next->get()));
+	}
+
+	Cursor nextAt_(Handle handle, Reference const& ref, std::size_t& hint) const override {
+		auto const* map = ref.isIndex() ? nullptr : std::get_if<Node::Map>(&nodeOf_(handle)->value);
+		if(map == nullptr) {
+			return this->nextAt_(handle, ref);
+		}
+
+		auto const key = ref.symbol();
+		if(hint < map->size() && (*map)[hint].first == key) {
+			return Cursor(*this, reinterpret_cast<Handle>((*map)[hint].second.get()));
+		}
+
+		for(std::size_t i = 0; i < map->size(); ++i) {
+			if((*map)[i].first == key) {
+				hint = i;
+				return Cursor(*this, reinterpret_cast<Handle>((*map)[i].second.get()));
+			}
+		}
+
+		return Cursor();
+	}
+
+	void keysAt_(Handle handle, std::function<bool(std::string const& key)> const& functor) const override {
+		auto const* map = std::get_if<Node::Map>(&nodeOf_(handle)->value);
+		if(map == nullptr) {
+			return;
+		}
+
+		for(auto const& [key, next]: *map) {
+			if(!functor(key.str())) {
+				return;
+			}
+		}
+	}
+
+	void entriesAt_(Handle handle, detail::FunctionRef<bool(std::string const& key, Cursor const& next)> functor) const override {
+		auto const* map = std::get_if<Node::Map>(&nodeOf_(handle)->value);
+		if(map == nullptr) {
+			return;
+		}
+
+		for(auto const& [key, next]: *map) {
+			if(!functor(key.str(), Cursor(*this, reinterpret_cast<Handle>(next.get())))) {
+				return;
+			}
+		}
+	}
+
+	std::size_t sizeAt_(Handle handle) const override {
+		auto const& value = nodeOf_(handle)->value;
+		if(auto const* map = std::get_if<Node::Map>(&value); map != nullptr) {
+			return map->size();
+		}
+		if(auto const* list = std::get_if<Node::List>(&value); list != nullptr) {
+			return list->size();
+		}
+
+		return 0;
+	}
+
+	bool hasAt_(Handle handle, Reference const& ref) const override {
+		auto const* next = findChild(nodeOf_(handle), ref);
+		return next != nullptr && *next != nullptr;
+	}
+
+	bool isAt_(Handle handle, Type type) const override {
+		if(handle == 0) {
+			return false;
+		}
+
+		auto const* node = nodeOf_(handle);
+		if(node->type() == type) {
+			return true;
+		}
+
+		switch(type) {
+		case Type::Bool: return node->as<StorageOf<Type::Bool>>() != nullptr;
+		case Type::Int: return node->as<StorageOf<Type::Int>>() != nullptr;
+		case Type::Num: return node->as<StorageOf<Type::Num>>() != nullptr;
+		default: return false;
+		}
+	}
+
+	void const* addressAt_(Handle handle) const override {
+		return reinterpret_cast<void const*>(handle);
+	}
+
+	// clang-format off
+	bool getAt_(Handle handle, StorageOf<Type::Nil>   value) const override { return this->get_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Bool>& value) const override { return this->get_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Int>&  value) const override { return this->get_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Num>&  value) const override { return this->get_(handle, value); }
+	bool getAt_(Handle handle, StorageOf<Type::Str>&  value) const override { return this->get_(handle, value); }
+
+	bool getAt_(Handle handle, std::span<StorageOf<Type::Int>> values) const override { return this->getAll_(handle, values); }
+	bool getAt_(Handle handle, std::span<StorageOf<Type::Num>> values) const override { return this->getAll_(handle, values); }
+	// clang-format on
+
+   private:
+	/**
+	 * @brief Node of \a handle, or an empty list if there is no such node so that callers need
+	 * no null check.
+	 */
+	static Node const* nodeOf_(Handle handle) {
+		static Node const empty{.value = Node::List()};
+		if(handle == 0) {
+			return &empty;
+		}
+
+		return reinterpret_cast<Node const*>(handle);
+	}
+
+	NodePtr const& curr_() const {
+		if(this->root_ == this->tree->root) {
+			return this->node_;
+		}
+
+		static NodePtr const none;
+
+		NodePtr const* curr = &this->tree->root;
+		for(auto const& ref: this->path) {
+			curr = findChild(curr->get(), ref);
+			if(curr == nullptr) {
+				curr = &none;
+				break;
+			}
+		}
+
+		this->root_ = this->tree->root;
+		this->node_ = *curr;
+
+		return this->node_;
+	}
+
+	std::shared_ptr<PersistentSource> child_(Reference const& ref) const {
+		auto path = this->path;
+		path.push_back(ref);
+
+		return std::make_shared<PersistentSource>(this->tree, std::move(path));
+	}
+
+	void assign_(detail::FunctionRef<NodePtr(NodePtr const& node)> fn) {
+		this->tree->root = assign(this->tree->root, this->path, fn);
+	}
+
+	template<typename V>
+	void set_(V&& value) {
+		this->assign_([&](NodePtr const& node) {
+			return makeNode(std::forward<V>(value));
+		});
+	}
+
+	template<typename V>
+	bool get_(Handle handle, V& value) const {
+		auto const* v = nodeOf_(handle)->template as<std::remove_cvref_t<V>>();
+		if(v == nullptr) {
+			return false;
+		}
+
+		if constexpr(!std::is_same_v<V, StorageOf<Type::Nil>>) {
+			value = *v;
+		}
+
+		return true;
+	}
+
+	template<typename V>
+	bool getAll_(Handle handle, std::span<V> values) const {
+		auto const* list = std::get_if<Node::List>(&nodeOf_(handle)->value);
+		if(list == nullptr || list->size() != values.size()) {
+			return false;
+		}
+
+		for(std::size_t i = 0; i < values.size(); ++i) {
+			auto const& next = (*list)[i];
+			if(next == nullptr) {
+				return false;
+			}
+
+			auto const* v = next->template as<V>();
+			if(v == nullptr) {
+				return false;
+			}
+
+			values[i] = *v;
+		}
+
+		return true;
+	}
+
+	// Node at `path` as of `root_`, the root of the tree when it was last resolved.
+	mutable NodePtr root_;
+	mutable NodePtr node_;
+};
+
+}  // namespace
+
+std::shared_ptr<Source> Source::persistent(Source const& source) {
+	return std::make_shared<PersistentSource>(std::make_shared<Tree>(Tree{.root = copyOf(Source::Cursor(source))}));
+}
+
+}  // namespace cray
@@ -0,0 +1,130 @@
+#include "cray/symbol.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace cray {
+
+struct Symbol::Table {
+	static Table& global() {
+		// Never destroyed so that Symbols in static storage can be released at exit.
+		static Table& table = *new Table;
+		return table;
+	}
+
+	std::shared_mutex mutex;
+
+	// Keys refer to the value of the mapped entry.
+	std::unordered_map<std::string_view, std::unique_ptr<Entry>> entries;
+
+	std::uint32_t next_id = 0;
+};
+
+Symbol::Symbol()
+    : entry_(Symbol::empty_()) { }
+
+Symbol::Symbol(std::string_view value)
+    : entry_(Symbol::intern_(value, true)) { }
+
+std::optional<Symbol> Symbol::find(std::string_view value) {
+	auto const* const entry = Symbol::intern_(value, false);
+	if(entry == nullptr) {
+		return std::nullopt;
+	}
+
+	return Symbol(entry);
+}
+
+Symbol::Entry const* Symbol::intern_(std::string_view value, bool insert) {
+	auto& table = Table::global();
+
+	{
+		std::shared_lock lock(table.mutex);
+
+		auto const it = table.entries.find(value);
+		if(it != table.entries.cend() && it->second->is_pinned) {
+			return it->second.get();
+		}
+		if(it != table.entries.cend()) {
+			// An entry whose count dropped to zero is about to be erased and cannot be revived.
+			auto& count = it->second->count;
+			auto  n     = count.load(std::memory_order_relaxed);
+			while(n != 0) {
+				if(count.compare_exchange_weak(n, n + 1, std::memory_order_relaxed)) {
+					return it->second.get();
+				}
+			}
+		}
+	}
+
+	if(!insert) {
+		return nullptr;
+	}
+
+	std::unique_lock lock(table.mutex);
+
+	// Another thread may have interned it while the lock was released.
+	auto it = table.entries.find(value);
+	if(it != table.entries.end() && it->second->is_pinned) {
+		return it->second.get();
+	}
+	if(it != table.entries.end()) {
+		if(it->second->count.fetch_add(1, std::memory_order_relaxed) != 0) {
+			return it->second.get();
+		}
+
+		// The entry is dying; leave it to the thread that released it, which finds it detached.
+		it->second->count.fetch_sub(1, std::memory_order_relaxed);
+		it->second.release();
+		table.entries.erase(it);
+	}
+
+	auto entry = std::unique_ptr<Entry>(new Entry{
+	    .value = std::string(value),
+	    .hash  = std::hash<std::string_view>()(value),
+	    .id    = table.next_id++,
+	    .count     = 1,
+	    .is_pinned = value.empty(),
+	});
+
+	auto const* const rst = entry.get();
+	table.entries.emplace(std::string_view(rst->value), std::move(entry));
+
+	return rst;
+}
+
+void Symbol::erase_(Entry const* entry) {
+	auto& table = Table::global();
+
+	std::unique_lock lock(table.mutex);
+
+	auto const it = table.entries.find(entry->value);
+	if(it != table.entries.end() && it->second.get() == entry) {
+		table.entries.erase(it);
+		return;
+	}
+
+	// Detached by an insertion of the same string while it was dying.
+	delete entry;
+}
+
+Symbol::Entry const* Symbol::empty_() noexcept {
+	static Entry const* const empty = Symbol::intern_(std::string_view(), true);
+	return empty;
+}
+
+std::ostream& operator<<(std::ostream& o, Symbol const& symbol) {
+	return o << symbol.str();
+}
+
+}  // namespace cray
@@ -0,0 +1,142 @@
+#include "cray/writer.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "cray/source.hpp"
+#include "cray/types.hpp"
+
+namespace cray {
+
+namespace {
+
+constexpr std::size_t BufferSize = 1 << 16;
+
+}  // namespace
+
+void Writer::write(Source::Cursor const& src) {
+	if(src.is(Type::Map)) {
+		this->beginMap();
+		src.entries([&](std::string const& key, Source::Cursor const& next) {
+			if(!this->wants(key)) {
+				return true;
+			}
+
+			this->key(key);
+			this->write(next);
+			return true;
+		});
+		this->endMap();
+	} else if(src.is(Type::List)) {
+		this->beginList();
+		std::size_t const size = src.size();
+		for(std::size_t i = 0; i < size; ++i) {
+			this->write(src.next(i));
+		}
+		this->endList();
+	} else {
+		this->scalar(src);
+	}
+}
+
+bool Writer::wants(std::string_view key) {
+	return true;
+}
+
+void Writer::scalar(Source::Cursor const& src) {
+	// A string is tried first so that the text of a plain scalar, such as `1.10` or `yes` in
+	// YAML, is not rewritten as the value it reads as.
+	if(src.is(Type::Str)) {
+		StorageOf<Type::Str> v;
+		src.get(v);
+		this->value(std::string_view(v));
+		return;
+	}
+
+	switch(src.type()) {
+	case Type::Bool: {
+		StorageOf<Type::Bool> v;
+		src.get(v);
+		this->value(v);
+		return;
+	}
+
+	case Type::Int: {
+		StorageOf<Type::Int> v;
+		src.get(v);
+		this->value(v);
+		return;
+	}
+
+	case Type::Num: {
+		StorageOf<Type::Num> v;
+		src.get(v);
+		this->value(v);
+		return;
+	}
+
+	default: {
+		this->value(nullptr);
+		return;
+	}
+	}
+}
+
+TextWriter::TextWriter(std::ostream& dst)
+    : dst_(dst) {
+	this->buffer_.reserve(BufferSize);
+}
+
+TextWriter::~TextWriter() {
+	this->flush();
+}
+
+void TextWriter::flush() {
+	this->dst_.write(this->buffer_.data(), this->buffer_.size());
+	this->buffer_.clear();
+}
+
+void TextWriter::put_(std::string_view text) {
+	this->buffer_.append(text);
+	if(this->buffer_.size() >= BufferSize) {
+		this->flush();
+	}
+}
+
+void TextWriter::put_(char c) {
+	this->buffer_.push_back(c);
+	if(this->buffer_.size() >= BufferSize) {
+		this->flush();
+	}
+}
+
+void TextWriter::put_(StorageOf<Type::Int> value) {
+	char buf[32];
+
+	auto const rst = std::to_chars(buf, buf + sizeof(buf), value);
+	this->put_(std::string_view(buf, rst.ptr - buf));
+}
+
+void TextWriter::put_(StorageOf<Type::Num> value) {
+	char buf[32];
+
+	auto const rst  = std::to_chars(buf, buf + sizeof(buf), value);
+	auto const text = std::string_view(buf, rst.ptr - buf);
+	this->put_(text);
+
+	// Otherwise it reads back as an integer.
+	if(text.find_first_of(".e") == std::string_view::npos) {
+		this->put_(".0");
+	}
+}
+
+void TextWriter::indent_(std::size_t width) {
+	for(std::size_t i = 0; i < width; ++i) {
+		this->put_(' ');
+	}
+}
+
+}  // namespace cray
@@ -0,0 +1,211 @@
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+
+#include "cray/source.hpp"
+#include "cray/types.hpp"
+#include "cray/writer.hpp"
+
+namespace cray {
+
+namespace {
+
+bool isDigit(char c) {
+	return '0' <= c && c <= '9';
+}
+
+/**
+ * @brief Whether \a value is a number in the JSON grammar.
+ */
+bool isNumber(std::string_view value) {
+	std::size_t i = 0;
+
+	auto const digits = [&] {
+		auto const begin = i;
+		while(i < value.size() && isDigit(value[i])) {
+			++i;
+		}
+
+		return i - begin;
+	};
+
+	if(i < value.size() && value[i] == '-') {
+		++i;
+	}
+
+	// No leading zeros.
+	auto const first = i;
+	if(digits() == 0 || (value[first] == '0' && i - first > 1)) {
+		return false;
+	}
+
+	if(i < value.size() && value[i] == '.') {
+		++i;
+		if(digits() == 0) {
+			return false;
+		}
+	}
+
+	if(i < value.size() && (value[i] == 'e' || value[i] == 'E')) {
+		++i;
+		if(i < value.size() && (value[i] == '+' || value[i] == '-')) {
+			++i;
+		}
+		if(digits() == 0) {
+			return false;
+		}
+	}
+
+	return i == value.size();
+}
+
+}  // namespace
+
+void JsonWriter::beginMap() {
+	this->begin_('{');
+}
+
+void JsonWriter::endMap() {
+	this->end_('}');
+}
+
+void JsonWriter::beginList() {
+	this->begin_('[');
+}
+
+void JsonWriter::endList() {
+	this->end_(']');
+}
+
+void JsonWriter::key(std::string_view key) {
+	this->item_();
+	this->str_(key);
+	this->put_(": ");
+	this->is_after_key_ = true;
+}
+
+void JsonWriter::value(StorageOf<Type::Nil> value) {
+	this->item_();
+	this->put_("null");
+	this->done_();
+}
+
+void JsonWriter::value(StorageOf<Type::Bool> value) {
+	this->item_();
+	this->put_(value ? "true" : "false");
+	this->done_();
+}
+
+void JsonWriter::value(StorageOf<Type::Int> value) {
+	this->item_();
+	this->put_(value);
+	this->done_();
+}
+
+void JsonWriter::value(StorageOf<Type::Num> value) {
+	this->item_();
+	if(std::isfinite(value)) {
+		this->put_(value);
+	} else {
+		// JSON has no representation for them.
+		this->put_("null");
+	}
+	this->done_();
+}
+
+void JsonWriter::value(std::string_view value) {
+	this->item_();
+	this->str_(value);
+	this->done_();
+}
+
+void JsonWriter::scalar(Source::Cursor const& src) {
+	bool const is_plain = src.is(Type::Str) && (src.is(Type::Bool) || src.is(Type::Int) || src.is(Type::Num));
+	if(!is_plain) {
+		return Writer::scalar(src);
+	}
+
+	StorageOf<Type::Str> value;
+	src.get(value);
+	if(!isNumber(value) && value != "true" && value != "false") {
+		return Writer::scalar(src);
+	}
+
+	this->item_();
+	this->put_(value);
+	this->done_();
+}
+
+void JsonWriter::begin_(char c) {
+	this->item_();
+	this->put_(c);
+	this->sizes_.push_back(0);
+}
+
+void JsonWriter::end_(char c) {
+	auto const size = this->sizes_.back();
+	this->sizes_.pop_back();
+
+	if(size > 0) {
+		this->put_('\n');
+		this->indent_(this->sizes_.size() * this->tab_size);
+	}
+	this->put_(c);
+	this->done_();
+}
+
+void JsonWriter::item_() {
+	if(this->is_after_key_) {
+		this->is_after_key_ = false;
+		return;
+	}
+	if(this->sizes_.empty()) {
+		return;
+	}
+
+	auto& size = this->sizes_.back();
+	if(size > 0) {
+		this->put_(',');
+	}
+	this->put_('\n');
+	this->indent_(this->sizes_.size() * this->tab_size);
+
+	++size;
+}
+
+void JsonWriter::str_(std::string_view value) {
+	constexpr char hex[] = "0123456789abcdef";
+
+	this->put_('"');
+	for(auto const c: value) {
+		switch(c) {
+		case '"': this->put_("\\\""); break;
+		case '\\': this->put_("\\\\"); break;
+		case '\n': this->put_("\\n"); break;
+		case '\r': this->put_("\\r"); break;
+		case '\t': this->put_("\\t"); break;
+
+		default: {
+			auto const u = static_cast<unsigned char>(c);
+			if(u < 0x20) {
+				this->put_("\\u00");
+				this->put_(hex[u >> 4]);
+				this->put_(hex[u & 0xF]);
+			} else {
+				this->put_(c);
+			}
+		}
+		}
+	}
+	this->put_('"');
+}
+
+void JsonWriter::done_() {
+	if(!this->sizes_.empty()) {
+		return;
+	}
+
+	this->put_('\n');
+}
+
+}  // namespace cray
@@ -0,0 +1,249 @@
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+
+#include "cray/source.hpp"
+#include "cray/types.hpp"
+#include "cray/writer.hpp"
+
+namespace cray {
+
+namespace {
+
+bool isPlain(std::string_view value) {
+	if(value.empty()) {
+		return false;
+	}
+
+	// May be read as a number.
+	auto const first = value.front();
+	if(std::isdigit(static_cast<unsigned char>(first)) || first == '.' || first == '-' || first == '+') {
+		return false;
+	}
+
+	for(auto const c: value) {
+		if(!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-' && c != '.' && c != '/') {
+			return false;
+		}
+	}
+
+	// May be read as a boolean or null.
+	constexpr std::string_view reserved[] = {"y", "n", "yes", "no", "on", "off", "true", "false", "null"};
+	for(auto const word: reserved) {
+		if(value.size() != word.size()) {
+			continue;
+		}
+
+		bool same = true;
+		for(std::size_t i = 0; i < word.size() && same; ++i) {
+			same = std::tolower(static_cast<unsigned char>(value[i])) == word[i];
+		}
+		if(same) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Whether \a value can be written unquoted without being read as a different token, given
+ * that it is the text of a plain scalar.
+ */
+bool isBare(std::string_view value) {
+	if(value.empty()) {
+		return false;
+	}
+
+	for(auto const c: value) {
+		if(!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-' && c != '+' && c != '.') {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}  // namespace
+
+void YamlWriter::beginMap() {
+	this->begin_(Type::Map);
+}
+
+void YamlWriter::endMap() {
+	this->end_();
+}
+
+void YamlWriter::beginList() {
+	this->begin_(Type::List);
+}
+
+void YamlWriter::endList() {
+	this->end_();
+}
+
+void YamlWriter::key(std::string_view key) {
+	this->item_();
+	this->str_(key);
+	this->put_(':');
+}
+
+void YamlWriter::value(StorageOf<Type::Nil> value) {
+	this->scalar_();
+	this->put_('~');
+	this->done_();
+}
+
+void YamlWriter::value(StorageOf<Type::Bool> value) {
+	this->scalar_();
+	this->put_(value ? "true" : "false");
+	this->done_();
+}
+
+void YamlWriter::value(StorageOf<Type::Int> value) {
+	this->scalar_();
+	this->put_(value);
+	this->done_();
+}
+
+void YamlWriter::value(StorageOf<Type::Num> value) {
+	this->scalar_();
+	if(std::isnan(value)) {
+		this->put_(".nan");
+	} else if(std::isinf(value)) {
+		this->put_(value < 0 ? "-.inf" : ".inf");
+	} else {
+		this->put_(value);
+	}
+	this->done_();
+}
+
+void YamlWriter::value(std::string_view value) {
+	this->scalar_();
+	this->str_(value);
+	this->done_();
+}
+
+void YamlWriter::scalar(Source::Cursor const& src) {
+	bool const is_plain = src.is(Type::Str) && (src.is(Type::Bool) || src.is(Type::Int) || src.is(Type::Num));
+	if(!is_plain) {
+		return Writer::scalar(src);
+	}
+
+	StorageOf<Type::Str> value;
+	src.get(value);
+	if(!isBare(value)) {
+		return Writer::scalar(src);
+	}
+
+	this->scalar_();
+	this->put_(value);
+	this->done_();
+}
+
+void YamlWriter::begin_(Type type) {
+	if(this->frames_.empty()) {
+		this->frames_.push_back(Frame{.type = type, .size = 0, .indent = 0, .is_inline = true});
+		return;
+	}
+
+	auto const& parent = this->frames_.back();
+	auto const  indent = parent.indent + this->tab_size;
+	if(parent.type == Type::List) {
+		this->item_();
+		this->put_('-');
+		this->frames_.push_back(Frame{.type = type, .size = 0, .indent = indent, .is_inline = true});
+	} else {
+		this->frames_.push_back(Frame{.type = type, .size = 0, .indent = indent, .is_inline = false});
+	}
+}
+
+void YamlWriter::end_() {
+	auto const frame = this->frames_.back();
+	this->frames_.pop_back();
+
+	if(frame.size == 0) {
+		if(this->is_line_open_) {
+			this->put_(' ');
+		}
+		this->put_(frame.type == Type::Map ? "{}" : "[]");
+		this->is_line_open_ = true;
+	}
+
+	this->done_();
+}
+
+void YamlWriter::item_() {
+	auto& frame = this->frames_.back();
+	if(frame.size == 0 && frame.is_inline) {
+		if(this->is_line_open_) {
+			this->put_(' ');
+		}
+	} else {
+		if(this->is_line_open_) {
+			this->put_('\n');
+		}
+		this->indent_(frame.indent);
+	}
+
+	++frame.size;
+	this->is_line_open_ = true;
+}
+
+void YamlWriter::scalar_() {
+	if(this->frames_.empty()) {
+		return;
+	}
+
+	if(this->frames_.back().type == Type::List) {
+		this->item_();
+		this->put_('-');
+	}
+
+	this->put_(' ');
+	this->is_line_open_ = true;
+}
+
+void YamlWriter::str_(std::string_view value) {
+	if(isPlain(value)) {
+		this->put_(value);
+		return;
+	}
+
+	constexpr char hex[] = "0123456789ABCDEF";
+
+	this->put_('"');
+	for(auto const c: value) {
+		switch(c) {
+		case '"': this->put_("\\\""); break;
+		case '\\': this->put_("\\\\"); break;
+		case '\n': this->put_("\\n"); break;
+		case '\r': this->put_("\\r"); break;
+		case '\t': this->put_("\\t"); break;
+
+		default: {
+			auto const u = static_cast<unsigned char>(c);
+			if(u < 0x20 || u == 0x7F) {
+				this->put_("\\x");
+				this->put_(hex[u >> 4]);
+				this->put_(hex[u & 0xF]);
+			} else {
+				this->put_(c);
+			}
+		}
+		}
+	}
+	this->put_('"');
+}
+
+void YamlWriter::done_() {
+	if(!this->frames_.empty()) {
+		return;
+	}
+
+	this->put_('\n');
+	this->is_line_open_ = false;
+}
+
+}  // namespace cray
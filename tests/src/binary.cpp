@@ -0,0 +1,159 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cray/diff.hpp>
+#include <cray/dump.hpp>
+#include <cray/load.hpp>
+#include <cray/source.hpp>
+#include <cray/types.hpp>
+
+namespace {
+
+// Snapshots must be aligned to 8 bytes, which `std::string` does not promise.
+std::vector<std::uint64_t> align(std::string const& data) {
+	std::vector<std::uint64_t> aligned((data.size() + 7) / 8);
+	std::memcpy(aligned.data(), data.data(), data.size());
+
+	return aligned;
+}
+
+std::span<std::byte const> bytesOf(std::vector<std::uint64_t> const& data, std::size_t size) {
+	return std::span<std::byte const>(reinterpret_cast<std::byte const*>(data.data()), size);
+}
+
+}  // namespace
+
+TEST_CASE("binary") {
+	using namespace cray;
+	using Entry = Source::Entry;
+	using _     = Entry::MapValueType;
+
+	auto const src = Source::make({
+	    _{"name", "hypnos"},
+	    _{"port", 8080},
+	    _{"ratio", 0.5},
+	    _{"debug", false},
+	    _{"nil", nullptr},
+	    _{"tags", Entry({"a", "b", "a"})},
+	    _{"matrix", Entry({Entry({1, 2, 3}), Entry({4, 5, 6})})},
+	    _{"nested", Entry({_{"name", "nyx"}, _{"empty", Entry(std::initializer_list<Entry>())}})},
+	});
+
+	std::ostringstream out;
+	dump::asBinary(out, *src);
+	auto const data    = out.str();
+	auto const aligned = align(data);
+
+	SECTION("read in place") {
+		auto const bin = Source::fromBinary(bytesOf(aligned, data.size()));
+		REQUIRE(diff(*src, *bin).empty());
+
+		Source::Cursor const c(*bin);
+		REQUIRE(c.is(Type::Map));
+		REQUIRE(8 == c.size());
+
+		StorageOf<Type::Str> name;
+		REQUIRE(c.next("name").get(name));
+		REQUIRE("hypnos" == name);
+
+		StorageOf<Type::Num> ratio = 0;
+		REQUIRE(c.next("ratio").get(ratio));
+		REQUIRE(0.5 == ratio);
+
+		REQUIRE(c.next("nil").is(Type::Nil));
+		REQUIRE(c.next("nested").next("empty").is(Type::List));
+		REQUIRE(!c.has("foo"));
+		REQUIRE(!c.next("tags").has(3));
+
+		std::vector<StorageOf<Type::Int>> row(3);
+		REQUIRE(c.next("matrix").next(1).get(std::span(row)));
+		REQUIRE(std::vector<StorageOf<Type::Int>>{4, 5, 6} == row);
+
+		REQUIRE(c.next("tags").next(0).address() != c.next("tags").next(2).address());
+	}
+
+	SECTION("read-only") {
+		auto const bin = Source::fromBinary(bytesOf(aligned, data.size()));
+		REQUIRE_THROWS(bin->next("port")->set(StorageOf<Type::Int>(443)));
+		REQUIRE(nullptr == std::as_const(*bin).next("foo"));
+	}
+
+	SECTION("mapped from a file") {
+		auto const path = std::filesystem::temp_directory_path() / "cray-binary-test.bin";
+		{
+			std::ofstream file(path, std::ios::binary);
+			dump::asBinary(file, *src);
+		}
+
+		auto const bin = load::fromBinary(path);
+		std::filesystem::remove(path);
+
+		REQUIRE(diff(*src, *bin).empty());
+	}
+
+	SECTION("plain scalars") {
+		auto const yaml = Source::parse("yaml", "version: 1.10\nzip: 007\nflag: yes\nport: 8080\n");
+
+		std::ostringstream out;
+		dump::asBinary(out, *yaml);
+		auto const data    = out.str();
+		auto const aligned = align(data);
+
+		auto const bin = Source::fromBinary(bytesOf(aligned, data.size()));
+		REQUIRE(diff(*yaml, *bin).empty());
+
+		Source::Cursor const c(*bin);
+
+		StorageOf<Type::Str> text;
+		REQUIRE(c.next("version").get(text));
+		REQUIRE("1.10" == text);
+		REQUIRE(c.next("zip").get(text));
+		REQUIRE("007" == text);
+		REQUIRE(c.next("flag").get(text));
+		REQUIRE("yes" == text);
+
+		StorageOf<Type::Num> version = 0;
+		REQUIRE(c.next("version").get(version));
+		REQUIRE(1.1 == version);
+
+		StorageOf<Type::Int> zip = 0;
+		REQUIRE(c.next("zip").get(zip));
+		REQUIRE(7 == zip);
+
+		StorageOf<Type::Bool> flag = false;
+		REQUIRE(c.next("flag").get(flag));
+		REQUIRE(flag);
+		REQUIRE(!c.next("flag").is(Type::Int));
+
+		StorageOf<Type::Int> port = 0;
+		REQUIRE(c.next("port").get(port));
+		REQUIRE(8080 == port);
+	}
+
+	SECTION("rejects corrupt input") {
+		REQUIRE_THROWS_AS(Source::fromBinary(bytesOf(aligned, 16)), std::invalid_argument);
+		REQUIRE_THROWS_AS(Source::fromBinary(bytesOf(aligned, data.size() - 1)), std::invalid_argument);
+
+		auto bad = data;
+		bad[0]   = 'X';
+		REQUIRE_THROWS_AS(Source::fromBinary(bytesOf(align(bad), bad.size())), std::invalid_argument);
+
+		// Points the root past the end of the byte pool.
+		bad = data;
+		std::uint64_t const offset = -1;
+		std::memcpy(bad.data() + 40 + 8, &offset, sizeof(offset));
+		REQUIRE_THROWS_AS(Source::fromBinary(bytesOf(align(bad), bad.size())), std::invalid_argument);
+	}
+}
@@ -0,0 +1,91 @@
+#include <memory>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cray/diff.hpp>
+#include <cray/load.hpp>
+#include <cray/path.hpp>
+#include <cray/source.hpp>
+#include <cray/types.hpp>
+
+TEST_CASE("diff") {
+	using namespace cray;
+	using Entry = Source::Entry;
+	using _     = Entry::MapValueType;
+
+	auto const make = [] {
+		return Source::make({
+		    _{"name", "hypnos"},
+		    _{"port", 8080},
+		    _{"tls", Entry({_{"enabled", true}, _{"ciphers", Entry({"a", "b"})}})},
+		});
+	};
+
+	SECTION("identical") {
+		auto const src = make();
+		REQUIRE(diff(*src, *src).empty());
+		REQUIRE(diff(*src, *make()).empty());
+	}
+
+	SECTION("added, removed and modified") {
+		auto const from = make();
+		auto const to   = make();
+		to->next("port")->set(StorageOf<Type::Int>(443));
+		to->next("tls")->next("ciphers")->next(2)->set(StorageOf<Type::Str>("c"));
+		to->next("tls")->next("enabled")->set(StorageOf<Type::Str>("yes"));
+		to->next("debug")->set(StorageOf<Type::Bool>(true));
+
+		auto const removed = Source::make({_{"port", 8080}});
+
+		REQUIRE(std::vector<Difference>{
+		            {Change::Modified, Path({"port"})},
+		            {Change::Modified, Path({"tls", "enabled"})},
+		            {Change::Added, Path({"tls", "ciphers", 2})},
+		            {Change::Added, Path({"debug"})},
+		        } == diff(*from, *to));
+		REQUIRE(std::vector<Difference>{
+		            {Change::Removed, Path({"name"})},
+		            {Change::Removed, Path({"tls"})},
+		        } == diff(*from, *removed));
+	}
+
+	SECTION("keys in another order") {
+		auto const from = Source::make({_{"a", 1}, _{"b", 2}, _{"c", 3}});
+		auto const to   = Source::make({_{"c", 3}, _{"a", 1}, _{"b", 4}});
+
+		REQUIRE(std::vector<Difference>{{Change::Modified, Path({"b"})}} == diff(*from, *to));
+	}
+
+	SECTION("YAML") {
+		std::stringstream in("a: [1, 2]\nb: x\n");
+		auto const from = load::fromYaml(in);
+
+		REQUIRE(std::vector<Difference>{
+		            {Change::Modified, Path({"a", 1})},
+		            {Change::Removed, Path({"b"})},
+		        } == diff(*from, *Source::make({_{"a", Entry({1, 3})}})));
+	}
+
+	SECTION("shared subtrees of snapshots are skipped") {
+		auto const curr = Source::persistent(*make());
+		auto const prev = curr->snapshot();
+		curr->next("port")->set(StorageOf<Type::Int>(443));
+
+		std::size_t visited = 0;
+
+		auto const tls_prev = Source::Cursor(*prev).next("tls");
+		auto const tls_curr = Source::Cursor(*curr).next("tls");
+		REQUIRE(nullptr != tls_prev.address());
+		REQUIRE(tls_prev.address() == tls_curr.address());
+
+		diff(*prev, *curr, [&](Change change, Path const& path) {
+			REQUIRE(Change::Modified == change);
+			REQUIRE(Path({"port"}) == path);
+			++visited;
+		});
+		REQUIRE(1 == visited);
+	}
+}
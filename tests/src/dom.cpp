@@ -0,0 +1,274 @@
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cray/dom.hpp>
+#include <cray/source.hpp>
+#include <cray/types.hpp>
+
+TEST_CASE("Dom") {
+	using namespace cray;
+
+	Dom dom;
+
+	auto const root = dom.root();
+	REQUIRE(dom.is(root, Type::Nil));
+
+	SECTION("scalars") {
+		StorageOf<Type::Bool> b;
+		StorageOf<Type::Int>  i;
+		StorageOf<Type::Num>  n;
+		StorageOf<Type::Str>  s;
+
+		dom.set(root, true);
+		REQUIRE(dom.get(root, b));
+		REQUIRE(b);
+		REQUIRE(!dom.get(root, i));
+
+		dom.set(root, StorageOf<Type::Int>(42));
+		REQUIRE(dom.get(root, i));
+		REQUIRE(42 == i);
+		REQUIRE(!dom.get(root, n));
+
+		dom.set(root, 3.14);
+		REQUIRE(dom.get(root, n));
+		REQUIRE(3.14 == n);
+		REQUIRE(!dom.get(root, s));
+
+		dom.set(root, "hypnos");
+		REQUIRE(dom.get(root, s));
+		REQUIRE("hypnos" == s);
+		REQUIRE("hypnos" == dom.str(root));
+		REQUIRE(0 == dom.size(root));
+	}
+
+	SECTION("plain strings") {
+		StorageOf<Type::Bool> b;
+		StorageOf<Type::Int>  i;
+		StorageOf<Type::Str>  s;
+
+		dom.setPlain(root, "0x1F");
+		REQUIRE(Type::Str == dom.type(root));
+		REQUIRE(dom.is(root, Type::Int));
+		REQUIRE(dom.is(root, Type::Num) == false);
+		REQUIRE(dom.get(root, i));
+		REQUIRE(31 == i);
+		REQUIRE(dom.get(root, s));
+		REQUIRE("0x1F" == s);
+
+		dom.setPlain(root, "Yes");
+		REQUIRE(dom.get(root, b));
+		REQUIRE(b);
+
+		dom.set(root, "Yes");
+		REQUIRE(!dom.is(root, Type::Bool));
+
+		dom.reset(root, Type::List);
+		dom.setPlain(dom.append(root), "1");
+		dom.set(dom.append(root), StorageOf<Type::Int>(2));
+
+		std::vector<StorageOf<Type::Int>> ints(2);
+		REQUIRE(dom.get(root, std::span(ints)));
+		REQUIRE(1 == ints.front());
+
+		Dom other;
+		other.graft(other.root(), dom, dom.at(root, 0));
+		REQUIRE(other.is(other.root(), Type::Int));
+	}
+
+	SECTION("external strings") {
+		std::string const text = "hypnos";
+
+		dom.setView(root, text);
+		REQUIRE(dom.is(root, Type::Str));
+		REQUIRE(text.data() == dom.str(root).data());
+		REQUIRE("hypnos" == dom.str(root));
+
+		Dom other;
+		other.graft(other.root(), dom, root);
+		REQUIRE("hypnos" == other.str(other.root()));
+		REQUIRE(text.data() != other.str(other.root()).data());
+
+		dom.set(root, "somnus");
+		REQUIRE("somnus" == dom.str(root));
+	}
+
+	SECTION("map") {
+		dom.reset(root, Type::Map);
+
+		auto const a = dom.child(root, "a");
+		auto const b = dom.child(root, "b");
+		REQUIRE(a == dom.child(root, "a"));
+		REQUIRE(2 == dom.size(root));
+		REQUIRE(dom.is(a, Type::Unspecified));
+
+		dom.set(a, StorageOf<Type::Int>(1));
+		dom.set(b, "2");
+		REQUIRE(a == dom.find(root, "a"));
+		REQUIRE(b == dom.find(root, "b"));
+		REQUIRE(Dom::npos == dom.find(root, "c"));
+
+		REQUIRE("a" == dom.keyAt(root, 0));
+		REQUIRE("b" == dom.keyAt(root, 1));
+		REQUIRE(a == dom.at(root, 0));
+		REQUIRE(b == dom.at(root, 1));
+		REQUIRE(Dom::npos == dom.at(root, 2));
+	}
+
+	SECTION("wide map") {
+		dom.reset(root, Type::Map);
+
+		std::vector<Dom::Index> children;
+		for(int i = 0; i < 100; ++i) {
+			children.push_back(dom.child(root, "k" + std::to_string(i)));
+		}
+		REQUIRE(100 == dom.size(root));
+
+		for(int i = 0; i < 100; ++i) {
+			auto const key = "k" + std::to_string(i);
+			REQUIRE(children[i] == dom.find(root, std::string_view(key)));
+			REQUIRE(children[i] == dom.child(root, Symbol(key)));
+
+			std::size_t hint = 0;
+			REQUIRE(children[i] == dom.find(root, Symbol(key), hint));
+			REQUIRE(i == hint);
+		}
+		REQUIRE(100 == dom.size(root));
+		REQUIRE(Dom::npos == dom.find(root, "k100"));
+
+		// A scalar grafted over the map drops its keys too.
+		Dom scalar;
+		dom.graft(root, scalar, scalar.root());
+		REQUIRE(dom.is(root, Type::Nil));
+
+		dom.reset(root, Type::Map);
+		for(int i = 99; i >= 0; --i) {
+			dom.child(root, "k" + std::to_string(i));
+		}
+		REQUIRE(100 == dom.size(root));
+		for(int i = 0; i < 100; ++i) {
+			std::size_t hint = 0;
+			REQUIRE(Dom::npos != dom.find(root, Symbol("k" + std::to_string(i)), hint));
+			REQUIRE(99 - i == hint);
+		}
+
+		// Keys of a map that replaces it are not found through the old one.
+		dom.reset(root, Type::Map);
+		REQUIRE(Dom::npos == dom.find(root, "k1"));
+
+		auto const k1 = dom.child(root, "k1");
+		REQUIRE(k1 == dom.find(root, "k1"));
+		REQUIRE(1 == dom.size(root));
+	}
+
+	SECTION("list") {
+		dom.reset(root, Type::List);
+
+		for(int i = 0; i < 100; ++i) {
+			dom.set(dom.append(root), StorageOf<Type::Int>(i));
+		}
+		REQUIRE(100 == dom.size(root));
+
+		for(std::size_t i = 0; i < 100; ++i) {
+			StorageOf<Type::Int> v;
+			REQUIRE(dom.get(dom.at(root, i), v));
+			REQUIRE(i == v);
+		}
+
+		auto const far = dom.child(root, 104);
+		REQUIRE(105 == dom.size(root));
+		REQUIRE(far == dom.at(root, 104));
+		REQUIRE(dom.is(dom.at(root, 102), Type::Unspecified));
+	}
+
+	SECTION("list of numbers") {
+		dom.reset(root, Type::List);
+		for(int i = 0; i < 10; ++i) {
+			dom.set(dom.append(root), StorageOf<Type::Num>(i));
+		}
+
+		std::vector<StorageOf<Type::Num>> values(10);
+		REQUIRE(dom.get(root, std::span(values)));
+		REQUIRE(9.0 == values.back());
+
+		std::vector<StorageOf<Type::Int>> ints(10);
+		REQUIRE(!dom.get(root, std::span(ints)));
+
+		values.resize(3);
+		REQUIRE(!dom.get(root, std::span(values)));
+	}
+
+	SECTION("interleaved containers") {
+		dom.reset(root, Type::List);
+
+		auto const a = dom.append(root);
+		auto const b = dom.append(root);
+		dom.reset(a, Type::List);
+		dom.reset(b, Type::List);
+		for(int i = 0; i < 10; ++i) {
+			dom.set(dom.append(a), StorageOf<Type::Int>(i));
+			dom.set(dom.append(b), StorageOf<Type::Int>(-i));
+		}
+
+		for(std::size_t i = 0; i < 10; ++i) {
+			StorageOf<Type::Int> v;
+			REQUIRE(dom.get(dom.at(a, i), v));
+			REQUIRE(i == v);
+			REQUIRE(dom.get(dom.at(b, i), v));
+			REQUIRE(-static_cast<StorageOf<Type::Int>>(i) == v);
+		}
+	}
+
+	SECTION("::graft") {
+		Dom src;
+		src.reset(src.root(), Type::Map);
+		src.set(src.child(src.root(), "name"), "lesomnus");
+
+		auto const list = src.child(src.root(), "list");
+		src.reset(list, Type::List);
+		src.set(src.append(list), true);
+
+		dom.graft(root, src, src.root());
+		REQUIRE(dom.is(root, Type::Map));
+		REQUIRE("lesomnus" == dom.str(dom.find(root, "name")));
+
+		auto const copied = dom.find(root, "list");
+		REQUIRE(1 == dom.size(copied));
+		REQUIRE(dom.is(dom.at(copied, 0), Type::Bool));
+
+		dom.graft(dom.child(root, "copy"), dom, copied);
+		REQUIRE(dom.is(dom.at(dom.find(root, "copy"), 0), Type::Bool));
+	}
+
+	SECTION("::clear") {
+		dom.reset(root, Type::Map);
+		dom.set(dom.child(root, "a"), "b");
+
+		dom.clear();
+		REQUIRE(dom.is(root, Type::Nil));
+		REQUIRE(0 == dom.size(root));
+	}
+}
+
+TEST_CASE("Source::fromDom") {
+	using namespace cray;
+
+	auto dom = std::make_shared<Dom>();
+	dom->reset(dom->root(), Type::Map);
+	dom->set(dom->child(dom->root(), "answer"), StorageOf<Type::Int>(42));
+
+	auto const source = Source::fromDom(dom);
+	REQUIRE(source->is(Type::Map));
+
+	StorageOf<Type::Int> v;
+	REQUIRE(source->next("answer")->get(v));
+	REQUIRE(42 == v);
+
+	source->next("name")->set(StorageOf<Type::Str>("hypnos"));
+	REQUIRE("hypnos" == dom->str(dom->find(dom->root(), "name")));
+}
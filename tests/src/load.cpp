@@ -0,0 +1,399 @@
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cray/load.hpp>
+#include <cray/props.hpp>
+#include <cray/source.hpp>
+#include <cray/types.hpp>
+
+namespace {
+
+class NullLoader: public cray::Loader {
+   public:
+	using Loader::load;
+
+	std::shared_ptr<cray::Source> load(std::istream& in) override {
+		return cray::Source::null();
+	}
+};
+
+class CountingFactory: public cray::LoaderFactory {
+   public:
+	std::string name() const override {
+		return "null";
+	}
+
+	std::shared_ptr<cray::Loader> make() const override {
+		++this->count;
+		return std::make_shared<NullLoader>();
+	}
+
+	mutable std::atomic<int> count = 0;
+};
+
+struct Item {
+	int n;
+};
+
+}  // namespace
+
+TEST_CASE("LoaderRegistry") {
+	using namespace cray;
+
+	LoaderRegistry registry;
+
+	auto const factory = std::make_shared<CountingFactory>();
+	registry.add(factory);
+	REQUIRE(registry.has("null"));
+	REQUIRE(nullptr == registry.acquire("foo"));
+
+	SECTION("reuses released loaders") {
+		Loader const* first = nullptr;
+		{
+			auto const loader = registry.acquire("null");
+			first             = loader.get();
+		}
+
+		auto const loader = registry.acquire("null");
+		REQUIRE(first == loader.get());
+		REQUIRE(1 == factory->count);
+	}
+
+	SECTION("loaders in use are not shared") {
+		auto const a = registry.acquire("null");
+		auto const b = registry.acquire("null");
+		REQUIRE(a != b);
+		REQUIRE(2 == factory->count);
+	}
+
+	SECTION("replaced factory") {
+		registry.acquire("null");
+
+		auto const other = std::make_shared<CountingFactory>();
+		registry.add(other);
+		registry.acquire("null");
+		REQUIRE(1 == factory->count);
+		REQUIRE(1 == other->count);
+	}
+
+	SECTION("each thread has its own pool") {
+		std::vector<std::thread> threads;
+		for(int i = 0; i < 4; ++i) {
+			threads.emplace_back([&] {
+				for(int j = 0; j < 100; ++j) {
+					auto const loader = registry.acquire("null");
+					loader->load(std::string_view("~"));
+				}
+			});
+		}
+		for(auto& thread: threads) {
+			thread.join();
+		}
+
+		REQUIRE(4 == factory->count);
+	}
+}
+
+TEST_CASE("load::fromFiles") {
+	using namespace cray;
+
+	auto const dir = std::filesystem::temp_directory_path() / "cray-load-test";
+	std::filesystem::create_directories(dir);
+
+	std::vector<std::filesystem::path> paths;
+	for(int i = 0; i < 8; ++i) {
+		auto const path = dir / ("fragment-" + std::to_string(i) + ".yaml");
+		std::ofstream(path) << "last: " << i << "\nfragment-" << i << ": true\n";
+		paths.push_back(path);
+	}
+
+	auto const check = [&](std::shared_ptr<Source> const& src) {
+		REQUIRE(src != nullptr);
+
+		StorageOf<Type::Int> last = 0;
+		REQUIRE(src->next("last")->get(last));
+		REQUIRE(7 == last);
+		REQUIRE(9 == src->size());
+	};
+
+	SECTION("built-in pool") {
+		check(load::fromFiles("yaml", paths));
+	}
+
+	SECTION("given executor") {
+		std::vector<std::thread> threads;
+
+		auto const src = load::fromFiles("yaml", paths, [&](std::function<void()> task) {
+			threads.emplace_back(std::move(task));
+		});
+		for(auto& thread: threads) {
+			thread.join();
+		}
+
+		check(src);
+	}
+
+	SECTION("error of the first failed file") {
+		auto const missing = dir / "missing.yaml";
+		paths.insert(paths.begin() + 2, missing);
+
+		REQUIRE_THROWS_AS(load::fromFiles("yaml", paths), std::system_error);
+		REQUIRE(nullptr == load::fromFiles("foo", paths));
+	}
+
+	std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("load::documents") {
+	using namespace cray;
+
+	std::stringstream in(R"(
+n: 1
+name: hypnos
+---
+n: 2
+name: &name nyx
+alias: *name
+---
+n: three
+...
+---
+[1, 2]
+)");
+
+	auto docs = load::documentsFromYaml(in);
+	REQUIRE(docs);
+
+	auto const schema = detail::getProp(
+	    prop<Type::Map>().to<Item>()
+	    | field("n", &Item::n));
+
+	std::vector<std::shared_ptr<Source>> sources;
+	for(auto const& doc: docs) {
+		sources.push_back(doc);
+	}
+	REQUIRE(4 == sources.size());
+
+	Item item;
+	REQUIRE(schema->decodeFrom(*sources[0], item));
+	REQUIRE(1 == item.n);
+	REQUIRE(schema->decodeFrom(*sources[1], item));
+	REQUIRE(2 == item.n);
+	REQUIRE(!schema->decodeFrom(*sources[2], item));
+	REQUIRE(sources[3]->is(Type::List));
+
+	StorageOf<Type::Str> alias;
+	REQUIRE(sources[1]->next("alias")->get(alias));
+	REQUIRE("nyx" == alias);
+
+	REQUIRE(!load::documents("foo", in));
+}
+
+TEST_CASE("load::elements") {
+	using namespace cray;
+
+	auto const item =
+	    prop<Type::Map>().to<Item>()
+	    | field("n", &Item::n);
+
+	auto const collect = [](std::string const& name, std::string const& data) {
+		std::stringstream                 in(data);
+		std::vector<StorageOf<Type::Int>> values;
+		load::elements(name, in, [&](Source::Cursor const& element) {
+			StorageOf<Type::Int> value = -1;
+			if(element.is(Type::Map)) {
+				element.next("n").get(value);
+			} else {
+				element.get(value);
+			}
+
+			values.push_back(value);
+			return true;
+		});
+
+		return values;
+	};
+
+	using Values = std::vector<StorageOf<Type::Int>>;
+
+	SECTION("yaml") {
+		CHECK(Values{1, 2, 3} == collect("yaml", "- {n: 1}\n- n: 2\n- 3\n"));
+		CHECK(Values{} == collect("yaml", "[]"));
+		CHECK(Values{} == collect("yaml", ""));
+	}
+
+	SECTION("json") {
+		CHECK(Values{1, 2, 3} == collect("json", R"([{"n": 1}, {"n": 2, "m": [",", "]"]}, 3])"));
+		CHECK(Values{-1, 4} == collect("json", " [ \"a\\\"]\" , 4 ] \n"));
+		CHECK(Values{} == collect("json", "[ ]"));
+		CHECK(Values{} == collect("json", "null"));
+		CHECK(Values{} == collect("json", ""));
+	}
+
+	SECTION("json larger than a chunk") {
+		std::string data = "[";
+		for(int i = 0; i < 20000; ++i) {
+			data += (i == 0 ? "" : ",") + std::string(R"({"n": )") + std::to_string(i) + R"(, "s": "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"})";
+		}
+		data += "]";
+
+		auto const values = collect("json", data);
+		REQUIRE(20000 == values.size());
+		CHECK(0 == values.front());
+		CHECK(19999 == values.back());
+	}
+
+	SECTION("stops when the functor returns false") {
+		for(auto const name: {"yaml", "json"}) {
+			std::stringstream in("[1, 2, 3]");
+
+			std::size_t n = 0;
+			load::elements(name, in, [&](Source::Cursor const&) { return ++n < 2; });
+			CHECK(2 == n);
+		}
+	}
+
+	SECTION("not a list") {
+		CHECK_THROWS_AS(collect("yaml", "n: 1"), std::invalid_argument);
+		CHECK_THROWS_AS(collect("json", R"({"n": 1})"), std::invalid_argument);
+		CHECK_THROWS_AS(collect("json", "[1, , 2]"), std::invalid_argument);
+		CHECK_THROWS_AS(collect("json", "[1, 2] 3"), std::invalid_argument);
+		CHECK_THROWS_AS(collect("json", "[1, 2"), std::invalid_argument);
+		CHECK_THROWS_AS(collect("foo", "[]"), std::invalid_argument);
+	}
+
+	SECTION("decodeElements") {
+		for(auto const name: {"yaml", "json"}) {
+			std::stringstream in(R"([{"n": 1}, {"n": 2}, {"n": "three"}, {"n": 4}])");
+
+			std::vector<int> values;
+
+			auto const rejected = load::decodeElements(name, in, item, [&](Item&& value) {
+				values.push_back(value.n);
+				return true;
+			});
+			REQUIRE(rejected.has_value());
+			CHECK(2 == *rejected);
+			CHECK(std::vector<int>{1, 2} == values);
+		}
+	}
+}
+
+TEST_CASE("load::jsonLines") {
+	using namespace cray;
+
+	auto const item =
+	    prop<Type::Map>().to<Item>()
+	    | field("n", &Item::n);
+
+	std::string const data = "{\"n\": 1}\n\n{\"n\": 2}\r\n  \n{\"n\": 3}";
+
+	SECTION("loader") {
+		auto const src = Source::parse("ndjson", data);
+		REQUIRE(src->is(Type::List));
+		REQUIRE(3 == src->size());
+
+		StorageOf<Type::Int> n;
+		REQUIRE(src->next(2)->next("n")->get(n));
+		CHECK(3 == n);
+
+		std::stringstream in(data);
+
+		std::size_t size = 0;
+		for(auto const& doc: load::documents("jsonl", in)) {
+			CHECK(doc->is(Type::Map));
+			++size;
+		}
+		CHECK(3 == size);
+	}
+
+	SECTION("in order") {
+		std::string lines;
+		for(int i = 0; i < 5000; ++i) {
+			lines += R"({"n": )" + std::to_string(i) + "}\n";
+		}
+
+		for(auto const use_executor: {false, true}) {
+			std::stringstream in(lines);
+
+			std::vector<std::thread> threads;
+
+			Executor executor;
+			if(use_executor) {
+				executor = [&](std::function<void()> task) { threads.emplace_back(std::move(task)); };
+			}
+
+			std::vector<int> values;
+
+			auto const rejected = load::decodeJsonLines(
+			    in, item, [&](Item&& value) {
+				    values.push_back(value.n);
+				    return true;
+			    },
+			    executor);
+			for(auto& thread: threads) {
+				thread.join();
+			}
+
+			CHECK(!rejected.has_value());
+			REQUIRE(5000 == values.size());
+			for(int i = 0; i < 5000; ++i) {
+				REQUIRE(i == values[i]);
+			}
+		}
+	}
+
+	SECTION("rejected") {
+		std::stringstream in("{\"n\": 1}\n{\"n\": \"two\"}\n{\"n\": 3}\n");
+
+		std::vector<int> values;
+
+		auto const rejected = load::decodeJsonLines(in, item, [&](Item&& value) {
+			values.push_back(value.n);
+			return true;
+		});
+		REQUIRE(rejected.has_value());
+		CHECK(1 == *rejected);
+		CHECK(std::vector<int>{1} == values);
+	}
+
+	SECTION("invalid record") {
+		std::stringstream in("{\"n\": 1}\n\n{\"n\": }\n");
+
+		std::vector<int> values;
+		try {
+			load::decodeJsonLines(in, item, [&](Item&& value) {
+				values.push_back(value.n);
+				return true;
+			});
+			FAIL("no error");
+		} catch(std::invalid_argument const& error) {
+			CHECK(std::string_view(error.what()).starts_with("line 3: "));
+		}
+		CHECK(std::vector<int>{1} == values);
+
+		// Lines are counted the same way by the loader.
+		try {
+			Source::parse("ndjson", "{\"n\": 1}\n\n{\"n\": }\n");
+			FAIL("no error");
+		} catch(std::invalid_argument const& error) {
+			CHECK(std::string_view(error.what()).starts_with("line 3: "));
+		}
+
+		CHECK_THROWS_AS(Source::parse("ndjson", "1\n[\n"), std::invalid_argument);
+	}
+}
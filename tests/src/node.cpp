@@ -1,6 +1,7 @@
 #include <memory>
 #include <optional>
 #include <type_traits>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -70,6 +71,14 @@ TEST_CASE("as") {
 		REQUIRE(be(node, (long double)(3.14)));
 	}
 
+	SECTION("integers as floating point") {
+		Node node(Source::parse("json", R"({"x": 1, "l": [1, 2.5, 3]})"));
+
+		REQUIRE(1.0 == node["x"].as<std::optional<double>>());
+		REQUIRE(std::vector<double>({1, 2.5, 3}) == node["l"].as<std::optional<std::vector<double>>>());
+		REQUIRE(node.ok());
+	}
+
 	SECTION("std::string") {
 		REQUIRE(be(Node(Source::make("hypnos")), std::string("hypnos")));
 	}
@@ -0,0 +1,97 @@
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cray/load.hpp>
+#include <cray/path.hpp>
+#include <cray/source.hpp>
+#include <cray/types.hpp>
+
+TEST_CASE("Path") {
+	using namespace cray;
+
+	SECTION("::fromPointer") {
+		REQUIRE(Path::fromPointer("").empty());
+		REQUIRE(Path({"server", "tls", "ciphers", 2}) == Path::fromPointer("/server/tls/ciphers/2"));
+		REQUIRE(Path({"a/b", "m~n"}) == Path::fromPointer("/a~1b/m~0n"));
+		REQUIRE(Path({"01", ""}) == Path::fromPointer("/01/"));
+
+		REQUIRE_THROWS_AS(Path::fromPointer("a"), std::invalid_argument);
+		REQUIRE_THROWS_AS(Path::fromPointer("/a~"), std::invalid_argument);
+		REQUIRE_THROWS_AS(Path::fromPointer("/a~2"), std::invalid_argument);
+	}
+
+	SECTION("::fromDotted") {
+		REQUIRE(Path::fromDotted("").empty());
+		REQUIRE(Path({"server", "tls", "ciphers", 2}) == Path::fromDotted("server.tls.ciphers[2]"));
+		REQUIRE(Path({0, "a", 1, 2}) == Path::fromDotted("[0].a[1][2]"));
+
+		REQUIRE_THROWS_AS(Path::fromDotted("a..b"), std::invalid_argument);
+		REQUIRE_THROWS_AS(Path::fromDotted("a[1"), std::invalid_argument);
+		REQUIRE_THROWS_AS(Path::fromDotted("a[b]"), std::invalid_argument);
+		REQUIRE_THROWS_AS(Path::fromDotted("a[0]b"), std::invalid_argument);
+	}
+
+	SECTION("::parse") {
+		REQUIRE(Path::fromPointer("/a/0") == Path::parse("/a/0"));
+		REQUIRE(Path::fromDotted("a[0]") == Path::parse("a[0]"));
+	}
+
+	SECTION("::pointer") {
+		REQUIRE("" == Path().pointer());
+		REQUIRE("/a~1b/m~0n/3" == Path({"a/b", "m~n", 3}).pointer());
+	}
+
+	SECTION("::resolve") {
+		using Entry = Source::Entry;
+		using _     = Entry::MapValueType;
+
+		auto const make = [] {
+			return Source::make({
+			    _{"server", Entry({
+			                    _{"tls", Entry({
+			                                 _{"ciphers", Entry({"a", "b", "c"})},
+			                             })},
+			                    _{"0", true},
+			                })},
+			});
+		};
+
+		auto const path = Path::parse("/server/tls/ciphers/2");
+
+		auto const src = make();
+		for(int i = 0; i < 2; ++i) {
+			StorageOf<Type::Str> v;
+			REQUIRE(path.resolve(*src).get(v));
+			REQUIRE("c" == v);
+		}
+
+		// Resolves against another document using hints of the previous one.
+		auto const reloaded = make();
+		reloaded->next("server")->next("tls")->next("ciphers")->next(2)->set(StorageOf<Type::Str>("d"));
+
+		StorageOf<Type::Str> v;
+		REQUIRE(path.resolve(*reloaded).get(v));
+		REQUIRE("d" == v);
+
+		REQUIRE(Path::parse("/server/0").resolve(*src).is(Type::Bool));
+		REQUIRE(!Path::parse("/server/tls/ciphers/3").resolve(*src));
+		REQUIRE(!Path::parse("server.tls.foo").resolve(*src));
+		REQUIRE(Path().resolve(*src).is(Type::Map));
+	}
+
+	SECTION("::resolve against YAML") {
+		std::stringstream ss;
+		ss << "a:\n  b: [1, 2, 3]\n";
+
+		auto const src = load::fromYaml(ss);
+
+		StorageOf<Type::Int> v;
+		REQUIRE(Path::parse("a.b[1]").resolve(*src).get(v));
+		REQUIRE(2 == v);
+	}
+}
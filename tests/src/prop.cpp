@@ -663,6 +663,20 @@ TEST_CASE("MonoListProp") {
 		REQUIRE(13 == value.at(2));
 	}
 
+	SECTION("::get numbers with constraints") {
+		Node node(Source::make({3, 5, 13, 21, 42}));
+
+		auto const clamped = node.is<Type::List>().of(prop<Type::Int>().interval(x <= 20).withClamp()).get();
+		REQUIRE(std::vector<StorageOf<Type::Int>>{3, 5, 13, 20, 20} == clamped);
+	}
+
+	SECTION("::get numbers with an element of another type") {
+		Node node(Source::make({3.0, 5.0, "13"}));
+
+		auto const value = node.is<Type::List>().of(prop<Type::Num>().defaultValue(-1)).get();
+		REQUIRE(std::vector<StorageOf<Type::Num>>{3.0, 5.0, -1} == value);
+	}
+
 	SECTION("nested") {
 		SECTION("::get") {
 			Node node(Source::make({
@@ -0,0 +1,211 @@
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cray/load.hpp>
+#include <cray/props.hpp>
+#include <cray/schema.hpp>
+#include <cray/source.hpp>
+#include <cray/types.hpp>
+
+namespace {
+
+struct Step {
+	std::string name;
+	std::string run;
+};
+
+struct Job {
+	std::string       runs_on;
+	std::vector<Step> steps;
+};
+
+struct Service {
+	std::string                                  name;
+	std::unordered_map<std::string, std::string> env;
+};
+
+}  // namespace
+
+TEST_CASE("Schema") {
+	using namespace cray;
+
+	auto step =
+	    prop<Type::Map>().to<Step>()
+	    | field("name", &Step::name)
+	    | field("run", &Step::run);
+
+	auto job =
+	    prop<Type::Map>().to<Job>()
+	    | field("runs-on", &Job::runs_on)
+	    | field("steps", &Job::steps, step);
+
+	Schema const schema(job);
+
+	auto const check = [&](std::string const& data) {
+		std::stringstream in(data);
+		bool const ok = schema.check("yaml", in);
+
+		// Same as checking the loaded document.
+		auto const src = load::parseYaml(data);
+		REQUIRE(detail::getProp(job)->okFrom(*src) == ok);
+		REQUIRE(schema.check(*src) == ok);
+
+		return ok;
+	};
+
+	REQUIRE(check(R"(
+runs-on: ubuntu-latest
+extra: {a: [1, 2, {b: c}]}
+steps:
+  - name: build
+    run: make
+  - name: test
+    run: make test
+)"));
+
+	REQUIRE(check(R"(
+runs-on: &os ubuntu-latest
+steps:
+  - &step
+    name: *os
+    run: make
+  - *step
+)"));
+
+	// Missing required key.
+	REQUIRE(!check(R"(
+steps:
+  - name: build
+    run: make
+)"));
+
+	// Rejected deep in a list.
+	REQUIRE(!check(R"(
+runs-on: ubuntu-latest
+steps:
+  - name: build
+    run: make
+  - name: test
+    run: {make: test}
+)"));
+
+	// Of another type.
+	REQUIRE(!check(R"(
+runs-on: [ubuntu-latest]
+steps: []
+)"));
+	REQUIRE(!check(R"(
+runs-on: ubuntu-latest
+steps: {name: build, run: make}
+)"));
+
+	// Nothing is required of a document that is absent.
+	REQUIRE(check(""));
+
+	std::stringstream in;
+	REQUIRE_THROWS(schema.check("foo", in));
+}
+
+TEST_CASE("Schema::load") {
+	using namespace cray;
+
+	auto service =
+	    prop<Type::Map>().to<Service>()
+	    | field("name", &Service::name)
+	    | field("env", &Service::env);
+
+	Schema const schema(service);
+
+	auto const load = [&](std::string const& name, std::string const& data) {
+		std::stringstream in(data);
+		return schema.load(name, in);
+	};
+
+	auto const verify = [](std::shared_ptr<Source> const& src) {
+		REQUIRE(src->is(Type::Map));
+		CHECK(2 == src->size());
+		CHECK(!src->has("other"));
+
+		StorageOf<Type::Str> name;
+		REQUIRE(src->next("name")->get(name));
+		CHECK("hypnos" == name);
+
+		// Maps of any key are loaded in full.
+		auto const env = src->next("env");
+		CHECK(2 == env->size());
+
+		StorageOf<Type::Int> port;
+		REQUIRE(env->next("PORT")->get(port));
+		CHECK(8080 == port);
+		CHECK(env->next("EXTRA")->next("a")->is(Type::List));
+	};
+
+	SECTION("yaml") {
+		auto const src = load("yaml", R"(
+other: &o {a: [1, 2, {b: c}]}
+name: hypnos
+env:
+  PORT: 8080
+  EXTRA: {a: [*o]}
+more: *o
+)");
+		verify(src);
+
+		auto const value = detail::getProp(service);
+		CHECK(value->okFrom(*src));
+	}
+
+	SECTION("yaml alias of a key") {
+		auto const src = load("yaml", R"(
+&n hypnos: x
+name: *n
+env: {PORT: 8080, EXTRA: {a: []}}
+)");
+		verify(src);
+	}
+
+	SECTION("yaml null key") {
+		auto const src = load("yaml", R"(
+~: x
+name: hypnos
+env: {PORT: 8080, EXTRA: {a: []}}
+)");
+		verify(src);
+	}
+
+	SECTION("json") {
+		// Skipped values are not even parsed.
+		auto const src = load("json", R"({
+	"other": {"a": [1, 2, {"b": tru}]},
+	"name": "hypnos",
+	"env": {"PORT": 8080, "EXTRA": {"a": []}},
+	"more": [1, x]
+})");
+		verify(src);
+	}
+
+	SECTION("yaml aliases expanding without bound") {
+		// "Billion laughs": each anchor holds nine aliases of the one before it.
+		std::string bomb = "a: &a [lol, lol, lol, lol, lol, lol, lol, lol, lol]\n";
+		for(char c = 'b'; c <= 'i'; ++c) {
+			auto const alias = std::string("*") + char(c - 1);
+			bomb += std::string{c, ':', ' ', '&', c} + " [" + alias;
+			for(int i = 1; i < 9; ++i) {
+				bomb += ", " + alias;
+			}
+			bomb += "]\n";
+		}
+		bomb += "name: hypnos\nenv: {}\n";
+		REQUIRE_THROWS_AS(load("yaml", bomb), std::invalid_argument);
+	}
+
+	SECTION("no loader") {
+		REQUIRE_THROWS_AS(load("foo", ""), std::invalid_argument);
+	}
+}
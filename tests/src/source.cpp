@@ -1,8 +1,16 @@
 #include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <span>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
 #include <utility>
+#include <vector>
 
 #include <catch2/catch_template_test_macros.hpp>
 
@@ -141,6 +149,67 @@ void source_test(std::function<std::shared_ptr<cray::Source>()> make) {
 		REQUIRE(!src->has("a"));
 	}
 
+	SECTION("::entries") {
+		std::vector<std::string> keys;
+		src->keys([&](std::string const& key) {
+			keys.push_back(key);
+			return true;
+		});
+
+		std::size_t i = 0;
+		src->entries([&](std::string const& key, std::shared_ptr<Source> const& next) {
+			REQUIRE(keys[i++] == key);
+			REQUIRE(next->is(Type::Int) == (key == "int"));
+			return true;
+		});
+		REQUIRE(keys.size() == i);
+
+		i = 0;
+		Source::Cursor(*src).entries([&](std::string const& key, Source::Cursor const& next) {
+			REQUIRE(keys[i++] == key);
+			REQUIRE(next.is(Type::List) == (key == "list"));
+			return i < 2;
+		});
+		REQUIRE(2 == i);
+
+		src->next("list")->entries([&](std::string const& key, std::shared_ptr<Source> const& next) {
+			FAIL("list has no entries");
+			return true;
+		});
+	}
+
+	SECTION("Cursor") {
+		Source::Cursor const cursor(*src);
+		REQUIRE(cursor.is(Type::Map));
+		REQUIRE(7 == cursor.size());
+		REQUIRE(cursor.has("list"));
+		REQUIRE(!cursor.has("not_exists"));
+
+		std::size_t cnt = 0;
+		cursor.keys([&](std::string const& key) {
+			REQUIRE(src->has(key));
+			return ++cnt < 3;
+		});
+		REQUIRE(3 == cnt);
+
+		StorageOf<Type::Int> i;
+		REQUIRE(cursor.next("int").get(i));
+		REQUIRE(42 == i);
+
+		StorageOf<Type::Str> s;
+		auto const list = cursor.next("list");
+		REQUIRE(list.is(Type::List));
+		REQUIRE(2 == list.size());
+		REQUIRE(list.next(1).next("str").get(s));
+		REQUIRE("somnus" == s);
+
+		REQUIRE(!cursor.next("not_exists"));
+		REQUIRE(!cursor.next("not_exists").is(Type::Nil));
+		REQUIRE(!cursor.next("not_exists").next("a").get(s));
+		REQUIRE(!list.next(42));
+		REQUIRE(!src->has("not_exists"));
+	}
+
 	SECTION("empty field") {
 		auto empty = src->next("empty");
 		auto get   = [&empty](auto v) -> bool {
@@ -505,7 +574,175 @@ TEST_CASE("Source::make") {
 	}
 }
 
-TEST_CASE("YamlSource") {
+TEST_CASE("Source::persistent") {
+	using namespace cray;
+	using _ = Source::Entry::MapValueType;
+
+	auto const make = [] {
+		return Source::persistent(*Source::make({
+		    _{"nil", nullptr},
+		    _{"b_t", true},
+		    _{"b_f", false},
+		    _{"int", 42},
+		    _{"num", 3.14},
+		    _{"str", "hypnos"},
+		    _{
+		        "list",
+		        {
+		            {_{"int", 42}, _{"num", 3.14}, _{"str", "hypnos"}},
+		            {_{"int", 1955}, _{"num", 2.718}, _{"str", "somnus"}},
+		        },
+		    },
+		}));
+	};
+
+	source_test(make);
+
+	SECTION("::snapshot") {
+		auto const curr = make();
+		auto const prev = curr->snapshot();
+
+		curr->next("list")->next(1)->next("str")->set(StorageOf<Type::Str>("lesomnus"));
+		curr->next("list")->next(2)->set(StorageOf<Type::Int>(3));
+		curr->next("int")->set(StorageOf<Type::Int>(74));
+
+		REQUIRE(eq(curr->next("list")->next(1)->next("str"), StorageOf<Type::Str>("lesomnus")));
+		REQUIRE(eq(curr->next("list")->next(2), StorageOf<Type::Int>(3)));
+		REQUIRE(eq(curr->next("int"), StorageOf<Type::Int>(74)));
+
+		REQUIRE(eq(prev->next("list")->next(1)->next("str"), StorageOf<Type::Str>("somnus")));
+		REQUIRE(2 == prev->next("list")->size());
+		REQUIRE(eq(prev->next("int"), StorageOf<Type::Int>(42)));
+
+		// Writes to a snapshot do not leak into the Source it was taken from.
+		prev->next("str")->set(StorageOf<Type::Str>("morpheus"));
+		REQUIRE(eq(curr->next("str"), StorageOf<Type::Str>("hypnos")));
+
+		auto const list = std::as_const(*curr).next("list")->snapshot();
+		REQUIRE(3 == list->size());
+		REQUIRE(eq(list->next(0)->next("int"), StorageOf<Type::Int>(42)));
+	}
+
+	SECTION("::snapshot of a mutable Source") {
+		auto const src  = Source::make({_{"a", 1}});
+		auto const snap = src->snapshot();
+
+		src->next("a")->set(StorageOf<Type::Int>(2));
+		REQUIRE(eq(snap->next("a"), StorageOf<Type::Int>(1)));
+	}
+
+	SECTION("plain scalars keep their text") {
+		auto const src = Source::parse("yaml", R"(
+v: 1.10
+z: 007
+b: yes
+)");
+
+		for(auto const& copy: {Source::persistent(*src), src->snapshot()}) {
+			REQUIRE(eq(copy->next("v"), StorageOf<Type::Str>("1.10")));
+			REQUIRE(eq(copy->next("z"), StorageOf<Type::Str>("007")));
+			REQUIRE(eq(copy->next("b"), StorageOf<Type::Str>("yes")));
+
+			REQUIRE(eq(copy->next("v"), StorageOf<Type::Num>(1.1)));
+			REQUIRE(eq(copy->next("z"), StorageOf<Type::Int>(7)));
+			REQUIRE(eq(copy->next("b"), StorageOf<Type::Bool>(true)));
+			REQUIRE(copy->next("z")->is(Type::Int));
+			REQUIRE(!copy->next("b")->is(Type::Int));
+		}
+	}
+}
+
+TEST_CASE("Source::overlay") {
+	using namespace cray;
+	using _ = Source::Entry::MapValueType;
+
+	SECTION("Source") {
+		source_test([] {
+			return Source::overlay({
+			    Source::make({
+			        _{"nil", nullptr},
+			        _{"b_t", false},
+			        _{"b_f", false},
+			        _{"int", 0},
+			        _{"num", 3.14},
+			        _{"str", "somnus"},
+			        _{
+			            "list",
+			            {
+			                {_{"int", 42}, _{"num", 3.14}, _{"str", "somnus"}},
+			                {_{"int", 1955}, _{"num", 2.718}, _{"str", "somnus"}},
+			            },
+			        },
+			    }),
+			    Source::make({
+			        _{"b_t", true},
+			        _{"int", 42},
+			        _{"list", Source::Entry({Source::Entry({_{"str", "hypnos"}})})},
+			    }),
+			    Source::make({
+			        _{"str", "hypnos"},
+			    }),
+			});
+		});
+	}
+
+	SECTION("upper layer hides nodes of another type") {
+		auto const base = Source::make({
+		    _{"a", {_{"b", 1}, _{"c", 2}}},
+		    _{"d", {_{"e", 3}}},
+		});
+		auto const top = Source::make({
+		    _{"a", "disabled"},
+		    _{"d", {_{"f", 4}}},
+		});
+
+		auto const src = Source::overlay({base, top});
+		REQUIRE(eq(src->next("a"), StorageOf<Type::Str>("disabled")));
+		REQUIRE(!src->next("a")->has("b"));
+		REQUIRE(2 == src->next("d")->size());
+		REQUIRE(eq(src->next("d")->next("e"), StorageOf<Type::Int>(3)));
+		REQUIRE(eq(src->next("d")->next("f"), StorageOf<Type::Int>(4)));
+	}
+
+	SECTION("writes go to the top layer") {
+		auto const base = Source::make({_{"a", {_{"b", 1}}}});
+		auto const top  = Source::make({_{"z", 0}});
+
+		auto const src = Source::overlay({base, top});
+		auto const a   = std::as_const(*src).next("a");
+		a->next("c")->set(StorageOf<Type::Int>(2));
+
+		REQUIRE(eq(a->next("b"), StorageOf<Type::Int>(1)));
+		REQUIRE(eq(a->next("c"), StorageOf<Type::Int>(2)));
+		REQUIRE(eq(top->next("a")->next("c"), StorageOf<Type::Int>(2)));
+		REQUIRE(!base->next("a")->has("c"));
+		REQUIRE(!top->next("a")->has("b"));
+	}
+
+	SECTION("children are cached until a write") {
+		auto const base = Source::make({_{"a", {_{"b", 1}, _{"c", 2}}}});
+		auto const top  = Source::make({_{"a", {_{"c", 3}}}});
+
+		auto const src = Source::overlay({base, top});
+		auto const a   = std::as_const(*src).next("a");
+		REQUIRE(a == std::as_const(*src).next("a"));
+		REQUIRE(a == src->next("a"));
+		REQUIRE(2 == a->size());
+
+		src->next("a")->next("d")->set(StorageOf<Type::Int>(4));
+		REQUIRE(3 == a->size());
+		REQUIRE(eq(a->next("d"), StorageOf<Type::Int>(4)));
+
+		src->next("a")->set(StorageOf<Type::Str>("disabled"));
+		REQUIRE(0 == a->size());
+		REQUIRE(nullptr == std::as_const(*a).next("b"));
+		REQUIRE(eq(a, StorageOf<Type::Str>("disabled")));
+	}
+
+	REQUIRE_THROWS_AS(Source::overlay({}), std::invalid_argument);
+}
+
+TEST_CASE("load::fromYaml") {
 	using namespace cray;
 
 	constexpr auto* data = R"(
@@ -531,4 +768,337 @@ list:
 	source_test([&in] {
 		return load::fromYaml(in);
 	});
+
+	SECTION("scalars") {
+		auto const src = Source::parse("yaml", R"(
+yes: Yes
+off: OFF
+mixed: yES
+hex: 0x1F
+oct: -010
+big: 9223372036854775807
+over: 9223372036854775808
+exp: 1e3
+inf: -.Inf
+nan: .NaN
+word: inf
+)");
+
+		auto const get = [&](char const* key) { return src->next(key); };
+
+		StorageOf<Type::Bool> b;
+		REQUIRE(get("yes")->get(b));
+		CHECK(b);
+		REQUIRE(get("off")->get(b));
+		CHECK(!b);
+		CHECK(!get("mixed")->is(Type::Bool));
+
+		StorageOf<Type::Int> i;
+		REQUIRE(get("hex")->get(i));
+		CHECK(0x1F == i);
+		REQUIRE(get("oct")->get(i));
+		CHECK(-8 == i);
+		REQUIRE(get("big")->get(i));
+		CHECK(9223372036854775807 == i);
+		CHECK(!get("over")->is(Type::Int));
+		CHECK(get("over")->is(Type::Num));
+		CHECK(!get("exp")->is(Type::Int));
+
+		StorageOf<Type::Num> n;
+		REQUIRE(get("exp")->get(n));
+		CHECK(1000 == n);
+		REQUIRE(get("inf")->get(n));
+		CHECK(-std::numeric_limits<double>::infinity() == n);
+		REQUIRE(get("nan")->get(n));
+		CHECK(n != n);
+		CHECK(!get("word")->is(Type::Num));
+
+		for(auto const* key: {"yes", "hex", "exp", "word"}) {
+			CHECK(get(key)->is(Type::Str));
+		}
+	}
+
+	SECTION("quoted scalars are strings") {
+		auto const src = Source::parse("yaml", R"(
+single: '42'
+double: "true"
+tagged: !!str 3.14
+)");
+
+		CHECK(!src->next("single")->is(Type::Int));
+		CHECK(!src->next("double")->is(Type::Bool));
+		CHECK(!src->next("tagged")->is(Type::Num));
+		CHECK(src->next("tagged")->is(Type::Str));
+	}
+
+	SECTION("null keys") {
+		for(auto const* data: {"null: 2", "~: 2", ": 2", "{: 2}", "&n ~: 2\nx: *n"}) {
+			auto const src = Source::parse("yaml", data);
+
+			StorageOf<Type::Int> v;
+			REQUIRE(src->next("null")->get(v));
+			CHECK(2 == v);
+		}
+
+		auto const src = Source::parse("yaml", "&n ~: 2\nx: *n\n");
+		CHECK(src->next("x")->is(Type::Nil));
+	}
+
+	SECTION("aliases") {
+		auto const src = Source::parse("yaml", R"(
+base: &base
+  port: 8080
+  &k host: localhost
+copy: *base
+*k : example.com
+)");
+
+		StorageOf<Type::Int> port;
+		REQUIRE(src->next("copy")->next("port")->get(port));
+		CHECK(8080 == port);
+
+		StorageOf<Type::Str> host;
+		REQUIRE(src->next("host")->get(host));
+		CHECK("example.com" == host);
+
+		// A value may be an alias of a key.
+		auto const key = Source::parse("yaml", "&a foo: bar\nbaz: *a\n");
+		REQUIRE(key->next("baz")->get(host));
+		CHECK("foo" == host);
+
+		CHECK_THROWS_AS(Source::parse("yaml", "&a [*a]"), std::invalid_argument);
+		CHECK_THROWS_AS(Source::parse("yaml", "[1]: x"), std::invalid_argument);
+	}
+
+	SECTION("aliases expanding without bound") {
+		// "Billion laughs": each anchor holds nine aliases of the one before it.
+		std::string bomb = "a: &a [lol, lol, lol, lol, lol, lol, lol, lol, lol]\n";
+		for(char c = 'b'; c <= 'i'; ++c) {
+			auto const alias = std::string("*") + char(c - 1);
+			bomb += std::string{c, ':', ' ', '&', c} + " [" + alias;
+			for(int i = 1; i < 9; ++i) {
+				bomb += ", " + alias;
+			}
+			bomb += "]\n";
+		}
+		CHECK_THROWS_AS(Source::parse("yaml", bomb), std::invalid_argument);
+	}
+
+	SECTION("wide map") {
+		std::string data;
+		std::string nested;
+		for(int i = 0; i < 100; ++i) {
+			auto const line = "k" + std::to_string(i) + ": " + std::to_string(i) + "\n";
+			data += line;
+			nested += "  " + line;
+		}
+
+		// A duplicated key keeps its position and takes the last value.
+		auto const src = Source::parse("yaml", "wide: &wide\n" + nested + "copy: *wide\n" + data + "k0: 1000\n");
+		auto const& map = std::as_const(*src);
+		CHECK(102 == map.size());
+		CHECK(100 == map.next("copy")->size());
+
+		std::vector<std::string> keys;
+		map.keys([&](std::string const& key) {
+			keys.push_back(key);
+			return keys.size() < 3;
+		});
+		CHECK(std::vector<std::string>{"wide", "copy", "k0"} == keys);
+
+		StorageOf<Type::Int> last;
+		REQUIRE(map.next("k0")->get(last));
+		CHECK(1000 == last);
+		REQUIRE(map.next("copy")->next("k99")->get(last));
+		CHECK(99 == last);
+
+		for(int i = 1; i < 100; ++i) {
+			auto const key = "k" + std::to_string(i);
+			REQUIRE(map.has(key));
+
+			StorageOf<Type::Int> value;
+			REQUIRE(map.next(key)->get(value));
+			CHECK(i == value);
+		}
+		CHECK(!map.has("k100"));
+
+		// Keys added by a write.
+		src->next("k100")->set(StorageOf<Type::Int>(100));
+		CHECK(map.has("k100"));
+	}
+}
+
+TEST_CASE("load::parseJson") {
+	using namespace cray;
+
+	constexpr auto* data = R"({
+	"nil": null,
+	"b_t": true,
+	"b_f": false,
+	"int": 42,
+	"num": 3.14,
+	"str": "hypnos",
+	"list": [
+		{"int": 42, "num": 3.14, "str": "hypnos"},
+		{"int": 1955, "num": 2.718, "str": "somnus"}
+	]
+})";
+
+	source_test([] {
+		return load::parseJson(data);
+	});
+
+	SECTION("scalars") {
+		auto const src = load::parseJson(R"({
+	"esc": "a\"b\\c\/d\n\u00e9\ud83d\ude00",
+	"key\u0041": 1,
+	"quoted": "42",
+	"neg": -0.5e-1,
+	"big": 9223372036854775808,
+	"dup": 1,
+	"dup": 2
+})");
+
+		StorageOf<Type::Str> str;
+		REQUIRE(src->next("esc")->get(str));
+		CHECK("a\"b\\c/d\n\u00e9\U0001F600" == str);
+		CHECK(src->has("keyA"));
+		CHECK(!src->next("quoted")->is(Type::Int));
+
+		StorageOf<Type::Num> num;
+		REQUIRE(src->next("neg")->get(num));
+		CHECK(-0.05 == num);
+		CHECK(src->next("big")->is(Type::Num));
+
+		StorageOf<Type::Int> value;
+		REQUIRE(src->next("dup")->get(value));
+		CHECK(2 == value);
+		CHECK(6 == src->size());
+	}
+
+	SECTION("wide object") {
+		std::string data = "{";
+		for(int i = 0; i < 10000; ++i) {
+			data += "\"k" + std::to_string(i) + "\": " + std::to_string(i) + ", ";
+		}
+		data += R"("k0": -1})";
+
+		auto const src = load::parseJson(data);
+		REQUIRE(10000 == src->size());
+
+		StorageOf<Type::Int> value;
+		REQUIRE(src->next("k0")->get(value));
+		CHECK(-1 == value);
+		REQUIRE(src->next("k9999")->get(value));
+		CHECK(9999 == value);
+		CHECK(!src->has("k10000"));
+	}
+
+	SECTION("empty document is nil") {
+		CHECK(load::parseJson(" \n")->is(Type::Nil));
+	}
+
+	SECTION("invalid documents") {
+		for(auto const* text: {"{", "[1,]", "{\"a\" 1}", "01", "1.", "tru", "\"\\x\"", "\"\\ud800\"", "\"a\nb\"", "1 2"}) {
+			CAPTURE(text);
+			CHECK_THROWS_AS(load::parseJson(text), std::invalid_argument);
+		}
+
+		std::string deep(1000, '[');
+		CHECK_THROWS_AS(load::parseJson(deep), std::invalid_argument);
+	}
+}
+
+TEST_CASE("load::parseJsonLazily") {
+	using namespace cray;
+
+	// Large enough that the root and "items" are scanned rather than parsed.
+	std::string data = R"({"name": "hypnos", "broken": {"a": tru}, "items": [)";
+	for(int i = 0; i < 10000; ++i) {
+		data += (i == 0 ? "" : ", ") + std::string(R"({"id": )") + std::to_string(i) + R"(, "tags": ["a\"]", "b"]})";
+	}
+	data += R"(], "name": "somnus"})";
+
+	auto const src = load::parseJsonLazily(data);
+	REQUIRE(src->is(Type::Map));
+	REQUIRE(3 == src->size());
+
+	std::vector<std::string> keys;
+	src->keys([&](std::string const& key) {
+		keys.push_back(key);
+		return true;
+	});
+	CHECK(std::vector<std::string>{"name", "broken", "items"} == keys);
+
+	StorageOf<Type::Str> name;
+	REQUIRE(src->next("name")->get(name));
+	CHECK("somnus" == name);
+
+	auto const items = std::as_const(*src).next("items");
+	REQUIRE(items->is(Type::List));
+	REQUIRE(10000 == items->size());
+
+	StorageOf<Type::Int> id;
+	REQUIRE(items->next(9999)->next("id")->get(id));
+	CHECK(9999 == id);
+
+	StorageOf<Type::Str> tag;
+	REQUIRE(items->next(42)->next("tags")->next(0)->get(tag));
+	CHECK("a\"]" == tag);
+
+	CHECK(std::as_const(*items).next(10000) == nullptr);
+	CHECK(!src->has("missing"));
+
+	// Only reported once read.
+	CHECK_THROWS_AS(src->next("broken")->is(Type::Map), std::invalid_argument);
+
+	CHECK_THROWS_AS(src->next("name")->set(StorageOf<Type::Str>("x")), detail::InvalidAccessError);
+	CHECK(load::parseJsonLazily(" ")->is(Type::Nil));
+
+	// Strings refer to the text, which a value read from it keeps alive.
+	auto text = std::make_shared<std::string>(R"({"name": "hypnos"})");
+	auto const value = load::parseJsonLazily(*text, text)->next("name");
+	text.reset();
+
+	REQUIRE(value->get(name));
+	CHECK("hypnos" == name);
+}
+
+TEST_CASE("Source::parse") {
+	using namespace cray;
+
+	std::string const data = "str: hypnos\nlist: [1, 2, 3]\n";
+
+	auto const check = [](std::shared_ptr<Source> const& src) {
+		REQUIRE(src != nullptr);
+		REQUIRE(eq(src->next("str"), StorageOf<Type::Str>("hypnos")));
+		REQUIRE(3 == src->next("list")->size());
+	};
+
+	check(load::parseYaml(data));
+	check(Source::parse("yaml", std::as_bytes(std::span(data))));
+	REQUIRE(nullptr == Source::parse("foo", data));
+}
+
+TEST_CASE("Source::load") {
+	using namespace cray;
+
+	std::string const data = "str: hypnos\nlist: [1, 2, 3]\n";
+
+	auto const path = std::filesystem::temp_directory_path() / "cray-source-load-test.yaml";
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << data;
+	}
+
+	LoadStats  stats;
+	auto const src = Source::load("yaml", path, stats);
+	std::filesystem::remove(path);
+
+	REQUIRE(src != nullptr);
+	REQUIRE(eq(src->next("str"), StorageOf<Type::Str>("hypnos")));
+	REQUIRE(data.size() == stats.bytes);
+	REQUIRE(stats.throughput() >= 0);
+
+	REQUIRE_THROWS_AS(Source::load("yaml", path), std::system_error);
 }
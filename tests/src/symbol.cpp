@@ -0,0 +1,66 @@
+#include <functional>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cray/symbol.hpp>
+#include <cray/types.hpp>
+
+TEST_CASE("Symbol") {
+	using namespace cray;
+
+	Symbol const a("hypnos");
+	Symbol const b(std::string("hypnos"));
+	REQUIRE(a == b);
+	REQUIRE(a.id() == b.id());
+	REQUIRE(a.hash() == std::hash<Symbol>()(b));
+	REQUIRE("hypnos" == a.str());
+
+	REQUIRE(!(a == Symbol("somnus")));
+	REQUIRE(Symbol() == Symbol(""));
+
+	REQUIRE(!Symbol::find("symbol that is never interned").has_value());
+	REQUIRE(a == Symbol::find("hypnos"));
+
+	std::stringstream ss;
+	ss << a;
+	REQUIRE("hypnos" == ss.str());
+
+	SECTION("released with the last Symbol") {
+		auto const id = [] {
+			Symbol const c("symbol that is released");
+			Symbol const d = c;
+			REQUIRE(Symbol::find("symbol that is released").has_value());
+			return c.id();
+		}();
+		REQUIRE(!Symbol::find("symbol that is released").has_value());
+
+		Symbol const c("symbol that is released");
+		REQUIRE(id != c.id());
+		REQUIRE("symbol that is released" == c.str());
+	}
+
+	SECTION("move") {
+		Symbol c("hypnos");
+		Symbol d(std::move(c));
+		REQUIRE(a == d);
+		REQUIRE(Symbol() == c);
+
+		c = std::move(d);
+		REQUIRE(a == c);
+		REQUIRE(Symbol() == d);
+	}
+
+	SECTION("Reference") {
+		Reference const ref(a);
+		REQUIRE(ref.isKey());
+		REQUIRE(a == ref.symbol());
+		REQUIRE(Reference("hypnos").symbol() == ref.symbol());
+		REQUIRE("hypnos" == ref.key());
+
+		auto const& key = Reference("hypnos").key();
+		REQUIRE("hypnos" == key);
+	}
+}
@@ -72,7 +72,7 @@ TEST_CASE("Reference") {
 	REQUIRE("hypnos" == Reference("hypnos").key());
 
 	auto const be = [](auto expected) {
-		return [&](auto value) {
+		return [=](auto value) {
 			using T = std::decay_t<decltype(expected)>;
 			using U = std::decay_t<decltype(value)>;
 
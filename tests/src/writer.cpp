@@ -0,0 +1,169 @@
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cray/diff.hpp>
+#include <cray/dom.hpp>
+#include <cray/dump.hpp>
+#include <cray/load.hpp>
+#include <cray/props.hpp>
+#include <cray/source.hpp>
+#include <cray/types.hpp>
+#include <cray/writer.hpp>
+
+namespace {
+
+struct Step {
+	std::string                name;
+	std::optional<std::string> run;
+};
+
+struct Job {
+	std::string       runs_on;
+	std::vector<Step> steps;
+};
+
+}  // namespace
+
+TEST_CASE("Writer") {
+	using namespace cray;
+	using Entry = Source::Entry;
+	using _     = Entry::MapValueType;
+
+	auto const src = Source::make({
+	    _{"name", "hypnos"},
+	    _{"tags", Entry({"a b", "true", "42", ""})},
+	    _{"matrix", Entry({Entry({1, 2}), Entry({_{"x", 1.0}, _{"y", 2.5}})})},
+	    _{"empty", Entry(std::initializer_list<Entry>())},
+	    _{"nil", nullptr},
+	    _{"quote", "say \"hi\"\n"},
+	});
+
+	SECTION("YAML") {
+		std::stringstream out;
+		dump::asYaml(out, *src);
+
+		constexpr auto* expected = R"(name: hypnos
+tags:
+  - "a b"
+  - "true"
+  - "42"
+  - ""
+matrix:
+  - - 1
+    - 2
+  - x: 1.0
+    "y": 2.5
+empty: []
+nil: ~
+quote: "say \"hi\"\n"
+)";
+		REQUIRE(expected == out.str());
+
+		auto const loaded = load::fromYaml(out);
+		REQUIRE(diff(Source::Cursor(*src).next("matrix"), Source::Cursor(*loaded).next("matrix")).empty());
+		REQUIRE(diff(Source::Cursor(*src).next("quote"), Source::Cursor(*loaded).next("quote")).empty());
+	}
+
+	SECTION("JSON") {
+		std::stringstream out;
+		dump::asJson(out, *src);
+
+		constexpr auto* expected = R"({
+  "name": "hypnos",
+  "tags": [
+    "a b",
+    "true",
+    "42",
+    ""
+  ],
+  "matrix": [
+    [
+      1,
+      2
+    ],
+    {
+      "x": 1.0,
+      "y": 2.5
+    }
+  ],
+  "empty": [],
+  "nil": null,
+  "quote": "say \"hi\"\n"
+}
+)";
+		REQUIRE(expected == out.str());
+	}
+
+	SECTION("plain scalars") {
+		auto const loaded = Source::parse("yaml", "version: 1.10\nzip: 007\nflag: yes\nport: 8080\nname: hypnos\n");
+
+		std::stringstream yaml;
+		dump::asYaml(yaml, *loaded);
+		REQUIRE("version: 1.10\nzip: 007\nflag: yes\nport: 8080\nname: hypnos\n" == yaml.str());
+
+		std::stringstream json;
+		dump::asJson(json, *loaded);
+		REQUIRE(R"({
+  "version": 1.10,
+  "zip": "007",
+  "flag": "yes",
+  "port": 8080,
+  "name": "hypnos"
+}
+)" == json.str());
+	}
+
+	SECTION("scalar at root") {
+		std::stringstream out;
+		dump::asYaml(out, *Source::make(std::numeric_limits<double>::infinity()));
+		dump::asJson(out, *Source::make(std::numeric_limits<double>::infinity()));
+		REQUIRE(".inf\nnull\n" == out.str());
+	}
+
+	SECTION("value described by Props") {
+		auto step =
+		    prop<Type::Map>().to<Step>()
+		    | field("name", &Step::name)
+		    | field("run", &Step::run);
+
+		auto job =
+		    prop<Type::Map>().to<Job>()
+		    | field("runs-on", &Job::runs_on)
+		    | field("steps", &Job::steps, step);
+
+		Job const value{
+		    .runs_on = "ubuntu-latest",
+		    .steps   = {
+		        {.name = "checkout"},
+		        {.name = "test", .run = "make test"},
+		    },
+		};
+
+		std::stringstream yaml;
+		dump::asYaml(yaml, job, value);
+		REQUIRE(R"(runs-on: ubuntu-latest
+steps:
+  - name: checkout
+  - name: test
+    run: "make test"
+)" == yaml.str());
+
+		// Same as writing the Source the value is encoded into.
+		auto const dst = Source::fromDom(std::make_shared<Dom>());
+		detail::getProp(job)->encodeInto(*dst, value);
+
+		std::stringstream expected;
+		dump::asJson(expected, *dst);
+
+		std::stringstream json;
+		dump::asJson(json, job, value);
+		REQUIRE(expected.str() == json.str());
+	}
+}